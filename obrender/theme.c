@@ -30,6 +30,8 @@
 #include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <time.h>
 
 struct fallbacks {
     RrAppearance *focused_disabled;
@@ -49,6 +51,7 @@ struct fallbacks {
 };
 
 static XrmDatabase loaddb(const gchar *name, gchar **path);
+static time_t dir_stamp(const gchar *path);
 static gboolean read_int(XrmDatabase db, const gchar *rname, gint *value);
 static gboolean read_string(XrmDatabase db, const gchar *rname, gchar **value);
 static gboolean read_color(XrmDatabase db, const RrInstance *inst,
@@ -940,7 +943,8 @@ RrTheme* RrThemeNew(const RrInstance *inst, const gchar *name,
     theme->a_menu_bullet_selected->texture[0].data.mask.color =
         theme->menu_bullet_selected_color;
 
-    g_free(path);
+    theme->path = path;
+    theme->stamp = dir_stamp(path);
     XrmDestroyDatabase(db);
 
     /* set the font heights */
@@ -1007,6 +1011,7 @@ void RrThemeFree(RrTheme *theme)
 {
     if (theme) {
         g_free(theme->name);
+        g_free(theme->path);
 
         RrButtonFree(theme->btn_max);
         RrButtonFree(theme->btn_close);
@@ -1112,6 +1117,38 @@ void RrThemeFree(RrTheme *theme)
     }
 }
 
+gboolean RrThemeChanged(const RrTheme *theme)
+{
+    return theme->stamp == -1 || dir_stamp(theme->path) != theme->stamp;
+}
+
+/*! Returns the last time the directory or any of the files in it changed,
+  or -1 if that was too recent to tell apart from a later change */
+static time_t dir_stamp(const gchar *path)
+{
+    GDir *dir;
+    const gchar *name;
+    struct stat s;
+    time_t stamp = 0;
+
+    if (stat(path, &s) == 0)
+        stamp = MAX(s.st_mtime, s.st_ctime);
+
+    if ((dir = g_dir_open(path, 0, NULL))) {
+        while ((name = g_dir_read_name(dir))) {
+            gchar *file = g_build_filename(path, name, NULL);
+            if (stat(file, &s) == 0)
+                stamp = MAX(stamp, MAX(s.st_mtime, s.st_ctime));
+            g_free(file);
+        }
+        g_dir_close(dir);
+    }
+
+    /* another change within the same second would not change the stamp, so
+       it can't be trusted yet */
+    return stamp >= time(NULL) ? -1 : stamp;
+}
+
 static XrmDatabase loaddb(const gchar *name, gchar **path)
 {
     GSList *it;
@@ -174,6 +174,11 @@ struct _RrTheme {
     RrAppearance *osd_focused_button;
 
     gchar *name;
+    /* the directory the theme was loaded from, and the last time anything
+       in it had changed when it was loaded, or -1 if that was too recent
+       to be sure of */
+    gchar *path;
+    time_t stamp;
 };
 
 /*! The font values are all optional. If a NULL is used for any of them, then
@@ -185,6 +190,10 @@ RrTheme* RrThemeNew(const RrInstance *inst, const gchar *theme,
                     RrFont *active_osd_font, RrFont *inactive_osd_font);
 void RrThemeFree(RrTheme *theme);
 
+/*! Returns TRUE if any of the theme's files have changed since it was
+  loaded */
+gboolean RrThemeChanged(const RrTheme *theme);
+
 G_END_DECLS
 
 #endif
@@ -16,24 +16,31 @@
    See the COPYING file for a copy of the GNU General Public License.
 */
 
+
 #include "obt/ddparse.h"
 #include "obt/link.h"
 #ifdef HAVE_STRING_H
 #include <string.h>
 #endif
-#ifdef HAVE_STDIO_H
-#include <stdio.h>
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
 #endif
 
-typedef struct _ObtDDParse ObtDDParse;
-
-/* Parses the value and adds it to the group's key_hash, with the given
-   key
-   Return TRUE if it is added to the hash table, and FALSE if not.
-*/
-typedef gboolean (*ObtDDParseValueFunc)(gchar *key, const gchar *val,
-                                        ObtDDParse *parse, gboolean *error);
+/* The file is read into one buffer and split into lines and tokens where
+   they lie, without copying anything.  Keys are matched against the table of
+   keys which are used, and only the values for those are copied out of the
+   file. */
 
+typedef struct _ObtDDParse ObtDDParse;
 
 enum {
     DE_TYPE             = 1 << 0,
@@ -48,18 +55,45 @@ struct _ObtDDParse {
     gchar *filename;
     gulong lineno;
     gulong flags;
+    /*! TRUE once a group has been found in the file */
+    gboolean seen_group;
+    /*! TRUE while reading keys in the [Desktop Entry] group */
+    gboolean in_entry;
     ObtDDParseGroup *group;
-    /* the key is a group name, the value is a ObtDDParseGroup */
-    GHashTable *group_hash;
 };
 
 struct _ObtDDParseGroup {
-    gchar *name;
-    gboolean seen;
-    ObtDDParseValueFunc value_func;
-    /* the key is a string (a key inside the group in the .desktop).
-       the value is an ObtDDParseValue */
-    GHashTable *key_hash;
+    /*! A bit for each ObtDDParseKey which was found in the file */
+    guint32 present;
+    ObtDDParseValue values[OBT_DDPARSE_NUM_KEYS];
+};
+
+static const struct {
+    const gchar *name;
+    gsize len;
+    ObtDDParseValueType type;
+    gulong flag; /*!< The DE_ flag set when the key is found */
+} keys[OBT_DDPARSE_NUM_KEYS] = {
+#define KEY(n, t, f) { n, sizeof(n) - 1, t, f }
+    KEY("Type",           OBT_DDPARSE_ENUM_TYPE,     DE_TYPE),
+    KEY("Name",           OBT_DDPARSE_LOCALESTRING,  DE_NAME),
+    KEY("GenericName",    OBT_DDPARSE_LOCALESTRING,  0),
+    KEY("NoDisplay",      OBT_DDPARSE_BOOLEAN,       0),
+    KEY("Comment",        OBT_DDPARSE_LOCALESTRING,  0),
+    KEY("Icon",           OBT_DDPARSE_LOCALESTRING,  0),
+    KEY("Hidden",         OBT_DDPARSE_BOOLEAN,       0),
+    KEY("OnlyShowIn",     OBT_DDPARSE_STRINGS,       0),
+    KEY("NotShowIn",      OBT_DDPARSE_STRINGS,       0),
+    KEY("TryExec",        OBT_DDPARSE_STRING,        0),
+    KEY("Exec",           OBT_DDPARSE_EXEC,          DE_EXEC),
+    KEY("Path",           OBT_DDPARSE_STRING,        0),
+    KEY("Terminal",       OBT_DDPARSE_BOOLEAN,       0),
+    KEY("MimeType",       OBT_DDPARSE_STRINGS,       0),
+    KEY("Categories",     OBT_DDPARSE_STRINGS,       0),
+    KEY("StartupNotify",  OBT_DDPARSE_BOOLEAN,       0),
+    KEY("StartupWMClass", OBT_DDPARSE_STRING,        0),
+    KEY("URL",            OBT_DDPARSE_STRING,        DE_URL)
+#undef KEY
 };
 
 /* Displays a warning message including the file name and line number, and
@@ -91,68 +125,60 @@ static void parse_value_free(ObtDDParseValue *v)
     case OBT_DDPARSE_BOOLEAN:
     case OBT_DDPARSE_NUMERIC:
     case OBT_DDPARSE_ENUM_TYPE:
-    case OBT_DDPARSE_ENVIRONMENTS:
         break;
     default:
         g_assert_not_reached();
     }
-    g_slice_free(ObtDDParseValue, v);
 }
 
-static ObtDDParseGroup* parse_group_new(gchar *name, ObtDDParseValueFunc f)
+/*! Frees all the values in the group, and empties it */
+static void parse_group_clear(ObtDDParseGroup *g)
 {
-    ObtDDParseGroup *g = g_slice_new(ObtDDParseGroup);
-    g->name = name;
-    g->value_func = f;
-    g->seen = FALSE;
-    g->key_hash = g_hash_table_new_full(g_str_hash, g_str_equal,
-                                        g_free,
-                                        (GDestroyNotify)parse_value_free);
-    return g;
-}
+    guint i;
 
-static void parse_group_free(ObtDDParseGroup *g)
-{
-    g_free(g->name);
-    g_hash_table_destroy(g->key_hash);
-    g_slice_free(ObtDDParseGroup, g);
+    for (i = 0; i < OBT_DDPARSE_NUM_KEYS; ++i)
+        if (g->present & (1 << i))
+            parse_value_free(&g->values[i]);
+    g->present = 0;
 }
 
 /*! Reads an input string, strips out invalid stuff, and parses
-    backslash-stuff.
+    backslash-stuff.  Stops at the first unescaped semicolon if
+    @semicolonterminate is TRUE.  Returns the number of bytes of the input
+    which were used in @used.
  */
 static gchar* parse_value_string(const gchar *in,
+                                 gsize inlen,
                                  gboolean locale,
                                  gboolean semicolonterminate,
-                                 gulong *len,
+                                 gsize *used,
                                  const ObtDDParse *const parse,
                                  gboolean *error)
 {
-    gint bytes;
     gboolean backslash;
     gchar *out, *o;
     const gchar *end, *i;
 
+    g_return_val_if_fail(in != NULL, NULL);
+
     /* find the end/size of the string */
     backslash = FALSE;
-    for (end = in; *end; ++end) {
-        if (semicolonterminate) {
+    end = in + inlen;
+    if (semicolonterminate)
+        for (i = in; i < end; ++i) {
             if (backslash) backslash = FALSE;
-            else if (*end == '\\') backslash = TRUE;
-            else if (*end == ';') break;
+            else if (*i == '\\') backslash = TRUE;
+            else if (*i == ';') {
+                end = i;
+                break;
+            }
         }
-    }
-    bytes = end - in;
+    if (used) *used = end - in;
 
-    g_return_val_if_fail(in != NULL, NULL);
-
-    if (locale && !g_utf8_validate(in, bytes, &end)) {
+    if (locale && !g_utf8_validate(in, end - in, &end))
         parse_error("Invalid bytes in localestring", parse, error);
-        bytes = end - in;
-    }
 
-    out = g_new(char, bytes + 1);
-    if (len) *len = 0;
+    out = g_new(char, end - in + 1);
     i = in; o = out;
     backslash = FALSE;
     while (i < end) {
@@ -180,16 +206,14 @@ static gchar* parse_value_string(const gchar *in,
         }
         else if (*i == '\\')
             backslash = TRUE;
-        else if ((guchar)*i >= 127 || (guchar)*i < 32) {
+        else if ((guchar)*i < 32 || (!locale && (guchar)*i >= 127)) {
             /* avoid ascii control characters */
             parse_error("Found control character in string", parse, error);
             break;
         }
         else {
-            const gulong s = next-i;
-            memcpy(o, i, s);
-            o += s;
-            if (len) *len += s;
+            memcpy(o, i, next-i);
+            o += next-i;
         }
         i = next;
     }
@@ -197,264 +221,197 @@ static gchar* parse_value_string(const gchar *in,
     return out;
 }
 
-
 /*! Reads a list of input strings, strips out invalid stuff, and parses
     backslash-stuff.
  */
 static gchar** parse_value_strings(const gchar *in,
+                                   gsize inlen,
                                    gboolean locale,
                                    gulong *nstrings,
                                    const ObtDDParse *const parse,
                                    gboolean *error)
 {
-    gchar **out;
-    const gchar *i;
-
-    out = g_new(gchar*, 1);
-    out[0] = NULL;
-    *nstrings = 0;
+    GPtrArray *out;
+    const gchar *i, *end;
 
+    out = g_ptr_array_new();
     i = in;
-    while (TRUE) {
+    end = in + inlen;
+    while (i < end) {
         gchar *a;
-        gulong len;
-
-        a = parse_value_string(i, locale, TRUE, &len, parse, error);
-        i += len;
-
-        if (len) {
-            (*nstrings)++;
-            out = g_renew(gchar*, out, *nstrings+1);
-            out[*nstrings-1] = a;
-            out[*nstrings] = NULL;
-        }
+        gsize used;
 
-        if (!*i) break; /* no more strings */
-        ++i;
-    }
-    return out;
-}
-
-static guint parse_value_environments(const gchar *in,
-                                      const ObtDDParse *const parse,
-                                      gboolean *error)
-{
-    const gchar *s;
-    guint mask = 0;
-
-    s = in;
-    while (*s) {
-        switch (*(s++)) {
-        case 'G':
-            if (strcmp(s, "NOME") == 0) {
-                mask |= OBT_LINK_ENV_GNOME;
-                s += 4;
-            }
-            break;
-        case 'K':
-            if (strcmp(s, "DE") == 0) {
-                mask |= OBT_LINK_ENV_KDE;
-                s += 2;
-            }
-            break;
-        case 'L':
-            if (strcmp(s, "XDE") == 0) {
-                mask |= OBT_LINK_ENV_LXDE;
-                s += 3;
-            }
-            break;
-        case 'R':
-            if (strcmp(s, "OX") == 0) {
-                mask |= OBT_LINK_ENV_ROX;
-                s += 2;
-            }
-            break;
-        case 'X':
-            if (strcmp(s, "FCE") == 0) {
-                mask |= OBT_LINK_ENV_XFCE;
-                s += 3;
-            }
-            break;
-        case 'O':
-            switch (*(s++)) {
-            case 'l':
-                if (strcmp(s, "d") == 0) {
-                    mask |= OBT_LINK_ENV_OLD;
-                    s += 1;
-                }
-                break;
-            case 'P':
-                if (strcmp(s, "ENBOX") == 0) {
-                    mask |= OBT_LINK_ENV_OPENBOX;
-                    s += 5;
-                }
-                break;
-            }
-        }
-        /* find the next string, or the end of the sequence */
-        while (*s && *s != ';') ++s;
+        a = parse_value_string(i, end - i, locale, TRUE, &used,
+                               parse, error);
+        if (*a)
+            g_ptr_array_add(out, a);
+        else
+            g_free(a);
+        i += used + 1; /* skip the semicolon */
     }
-    return mask;
+    *nstrings = out->len;
+    g_ptr_array_add(out, NULL);
+    return (gchar**)g_ptr_array_free(out, FALSE);
 }
 
 static gboolean parse_value_boolean(const gchar *in,
+                                    gsize inlen,
                                     const ObtDDParse *const parse,
                                     gboolean *error)
 {
-    if (strcmp(in, "true") == 0)
+    if (inlen == 4 && !memcmp(in, "true", 4))
         return TRUE;
-    else if (strcmp(in, "false") != 0)
+    else if (!(inlen == 5 && !memcmp(in, "false", 5)))
         parse_error("Invalid boolean value", parse, error);
     return FALSE;
 }
 
-static gfloat parse_value_numeric(const gchar *in,
-                                  const ObtDDParse *const parse,
-                                  gboolean *error)
+/*! Checks that an Exec value only uses one of the file/url-opening %'s */
+static void check_exec(const gchar *exec, const ObtDDParse *const parse,
+                       gboolean *error)
 {
-    gfloat out = 0;
-    if (sscanf(in, "%f", &out) == 0)
-        parse_error("Invalid numeric value", parse, error);
-    return out;
+    const gchar *c;
+    gchar *m;
+    gboolean percent;
+    gboolean found;
+
+    percent = found = FALSE;
+    for (c = exec; *c; ++c) {
+        if (percent) {
+            switch (*c) {
+            case 'f':
+            case 'F':
+            case 'u':
+            case 'U':
+                if (found) {
+                    m = g_strdup_printf("Malformed Exec key, "
+                                        "extraneous %%%c", *c);
+                    parse_error(m, parse, error);
+                    g_free(m);
+                }
+                found = TRUE;
+                break;
+            case 'd':
+            case 'D':
+            case 'n':
+            case 'N':
+            case 'v':
+            case 'm':
+                m = g_strdup_printf("Malformed Exec key, "
+                                    "uses deprecated %%%c", *c);
+                parse_error(m, parse, NULL); /* just a warning */
+                g_free(m);
+                break;
+            case 'i':
+            case 'c':
+            case 'k':
+            case '%':
+                break;
+            default:
+                m = g_strdup_printf("Malformed Exec key, "
+                                    "uses unknown %%%c", *c);
+                parse_error(m, parse, NULL); /* just a warning */
+                g_free(m);
+            }
+            percent = FALSE;
+        }
+        else if (*c == '%') percent = TRUE;
+    }
 }
 
-static gboolean parse_file_line(FILE *f, gchar **buf,
-                                gulong *size, gulong *read,
-                                ObtDDParse *parse, gboolean *error)
+/*! Parses the value for a key into the group.  Returns FALSE if the value
+  was not valid. */
+static gboolean parse_value(ObtDDParseKey key, const gchar *val, gsize len,
+                            ObtDDParse *parse, gboolean *error)
 {
-    const gulong BUFMUL = 80;
-    size_t ret;
-    gulong i, null;
-
-    if (*size == 0) {
-        g_assert(*read == 0);
-        *size = BUFMUL;
-        *buf = g_new(char, *size);
-    }
-
-    /* remove everything up to a null zero already in the buffer and shift
-       the rest to the front */
-    null = *size;
-    for (i = 0; i < *read; ++i) {
-        if (null < *size)
-            (*buf)[i-null-1] = (*buf)[i];
-        else if ((*buf)[i] == '\0')
-            null = i;
-    }
-    if (null < *size)
-        *read -= null + 1;
-
-    /* is there already a newline in the buffer? */
-    for (i = 0; i < *read; ++i)
-        if ((*buf)[i] == '\n') {
-            /* turn it into a null zero and done */
-            (*buf)[i] = '\0';
-            return TRUE;
-        }
+    ObtDDParseValue v;
 
-    /* we need to read some more to find a newline */
-    while (TRUE) {
-        gulong eol;
-        gchar *newread;
-
-        newread = *buf + *read;
-        ret = fread(newread, sizeof(char), *size-*read, f);
-        if (ret < *size - *read && !feof(f)) {
-            parse_error("Error reading", parse, error);
-            return FALSE;
-        }
-        *read += ret;
-
-        /* strip out null zeros in the input and look for an endofline */
-        null = 0;
-        eol = *size;
-        for (i = newread-*buf; i < *read; ++i) {
-            if (null > 0)
-                (*buf)[i] = (*buf)[i+null];
-            if ((*buf)[i] == '\0') {
-                ++null;
-                --(*read);
-                --i; /* try again */
-            }
-            else if ((*buf)[i] == '\n' && eol == *size) {
-                eol = i;
-                /* turn it into a null zero */
-                (*buf)[i] = '\0';
-            }
+    v.type = keys[key].type;
+    switch (v.type) {
+    case OBT_DDPARSE_EXEC:
+        v.value.string = parse_value_string(val, len, FALSE, FALSE, NULL,
+                                            parse, error);
+        check_exec(v.value.string, parse, error);
+        break;
+    case OBT_DDPARSE_STRING:
+        v.value.string = parse_value_string(val, len, FALSE, FALSE, NULL,
+                                            parse, error);
+        break;
+    case OBT_DDPARSE_LOCALESTRING:
+        v.value.string = parse_value_string(val, len, TRUE, FALSE, NULL,
+                                            parse, error);
+        break;
+    case OBT_DDPARSE_STRINGS:
+        v.value.strings.a = parse_value_strings(val, len, FALSE,
+                                                &v.value.strings.n,
+                                                parse, error);
+        break;
+    case OBT_DDPARSE_LOCALESTRINGS:
+        v.value.strings.a = parse_value_strings(val, len, TRUE,
+                                                &v.value.strings.n,
+                                                parse, error);
+        break;
+    case OBT_DDPARSE_BOOLEAN:
+        v.value.boolean = parse_value_boolean(val, len, parse, error);
+        break;
+    case OBT_DDPARSE_ENUM_TYPE:
+        if (len == 11 && !memcmp(val, "Application", 11)) {
+            v.value.enumerable = OBT_LINK_TYPE_APPLICATION;
+            parse->flags |= DE_TYPE_APPLICATION;
         }
-
-        if (eol != *size)
-            /* found an endofline, done */
-            break;
-        else if (feof(f) && *read < *size) {
-            /* found the endoffile, done (if there is space) */
-            if (*read > 0) {
-                /* stick a null zero on if there is test on the last line */
-                (*buf)[(*read)++] = '\0';
-            }
-            break;
+        else if (len == 4 && !memcmp(val, "Link", 4)) {
+            v.value.enumerable = OBT_LINK_TYPE_URL;
+            parse->flags |= DE_TYPE_LINK;
         }
+        else if (len == 9 && !memcmp(val, "Directory", 9))
+            v.value.enumerable = OBT_LINK_TYPE_DIRECTORY;
         else {
-            /* read more */
-            size += BUFMUL;
-            *buf = g_renew(char, *buf, *size);
+            parse_error("Unknown Type", parse, error);
+            return FALSE;
         }
+        break;
+    default:
+        g_assert_not_reached();
     }
-    return *read > 0;
+
+    parse->group->values[key] = v;
+    parse->group->present |= 1 << key;
+    parse->flags |= keys[key].flag;
+    return TRUE;
 }
 
-static void parse_group(const gchar *buf, gulong len,
+static void parse_group(const gchar *buf, gsize len,
                         ObtDDParse *parse, gboolean *error)
 {
-    ObtDDParseGroup *g;
-    gchar *group;
-    gulong i;
-
-    /* get the group name */
-    group = g_strndup(buf+1, len-2);
-    for (i = 0; i < len-2; ++i)
-        if ((guchar)group[i] < 32 || (guchar)group[i] >= 127) {
+    const gchar *name = buf + 1;
+    gsize i, namelen = len - 2;
+
+    for (i = 0; i < namelen; ++i)
+        if ((guchar)name[i] < 32 || (guchar)name[i] >= 127) {
             /* valid ASCII only */
             parse_error("Invalid character found", parse, NULL);
-            group[i] = '\0'; /* stopping before this character */
+            namelen = i; /* stopping before this character */
             break;
         }
 
+    parse->in_entry = (namelen == 13 && !memcmp(name, "Desktop Entry", 13));
+
     /* make sure it's a new group */
-    g = g_hash_table_lookup(parse->group_hash, group);
-    if (g && g->seen) {
+    if (parse->in_entry && parse->seen_group)
         parse_error("Duplicate group found", parse, error);
-        g_free(group);
-        return;
-    }
     /* if it's the first group, make sure it's named Desktop Entry */
-    else if (!parse->group && strcmp(group, "Desktop Entry") != 0)
-    {
+    else if (!parse->seen_group && !parse->in_entry)
         parse_error("Incorrect group found, "
                     "expected [Desktop Entry]",
                     parse, error);
-        g_free(group);
-        return;
-    }
-    else {
-        if (!g) {
-            g = parse_group_new(group, NULL);
-            g_hash_table_insert(parse->group_hash, g->name, g);
-        }
-        else
-            g_free(group);
-
-        g->seen = TRUE;
-        parse->group = g;
-        g_print("Found group %s\n", g->name);
-    }
+    parse->seen_group = TRUE;
 }
 
-static void parse_key_value(const gchar *buf, gulong len,
+static void parse_key_value(const gchar *buf, gsize len,
                             ObtDDParse *parse, gboolean *error)
 {
-    gulong i, keyend, valstart, eq;
-    char *key;
+    gsize i, keyend, valstart;
+    guint k;
 
     /* find the end of the key */
     for (i = 0; i < len; ++i)
@@ -471,346 +428,178 @@ static void parse_key_value(const gchar *buf, gulong len,
         parse_error("Empty key", parse, error);
         return;
     }
-    /* find the = character */
-    for (i = keyend; i < len; ++i) {
-        if (buf[i] == '=') {
-            eq = i;
+    /* localized values are not used */
+    if (keyend < len && buf[keyend] == '[')
+        return;
+
+    /* find the key in the table of keys which are used */
+    for (k = 0; k < OBT_DDPARSE_NUM_KEYS; ++k)
+        if (keys[k].len == keyend && !memcmp(keys[k].name, buf, keyend))
             break;
-        }
-        else if (buf[i] != ' ') {
+    if (k == OBT_DDPARSE_NUM_KEYS)
+        return; /* skip keys which aren't used */
+
+    /* find the = character */
+    for (i = keyend; i < len && buf[i] != '='; ++i)
+        if (buf[i] != ' ') {
             parse_error("Invalid character in key name", parse, error);
-            return ;
+            return;
         }
-    }
     if (i == len) {
         parse_error("Key without value found", parse, error);
         return;
     }
     /* find the start of the value */
-    for (i = eq+1; i < len; ++i)
-        if (buf[i] != ' ') {
-            valstart = i;
-            break;
-        }
+    for (++i; i < len && buf[i] == ' '; ++i);
     if (i == len) {
         parse_error("Empty value found", parse, error);
         return;
     }
+    valstart = i;
 
-    key = g_strndup(buf, keyend);
-    if (g_hash_table_lookup(parse->group->key_hash, key)) {
+    if (parse->group->present & (1 << k)) {
         parse_error("Duplicate key found", parse, error);
-        g_free(key);
         return;
     }
-    g_print("Found key/value %s=%s.\n", key, buf+valstart);
-    if (parse->group->value_func)
-        if (!parse->group->value_func(key, buf+valstart, parse, error)) {
-            parse_error("Unknown key", parse, error);
-            g_free(key);
-        }
+    parse_value(k, buf + valstart, len - valstart, parse, error);
 }
 
-static gboolean parse_file(FILE *f, ObtDDParse *parse)
+static gboolean parse_buffer(const gchar *buf, gsize size, ObtDDParse *parse)
 {
-    gchar *buf = NULL;
-    gulong bytes = 0, read = 0;
+    const gchar *p, *end;
     gboolean error = FALSE;
 
-    while (!error && parse_file_line(f, &buf, &bytes, &read, parse, &error)) {
-        gulong len = strlen(buf);
-        if (buf[0] == '#' || buf[0] == '\0')
+    end = buf + size;
+    for (p = buf; !error && p < end; ++parse->lineno) {
+        const gchar *eol;
+        gsize len;
+
+        if (!(eol = memchr(p, '\n', end - p)))
+            eol = end;
+        len = eol - p;
+
+        if (len == 0 || p[0] == '#')
             ; /* ignore comment lines */
-        else if (buf[0] == '[' && buf[len-1] == ']')
-            parse_group(buf, len, parse, &error);
-        else if (!parse->group)
+        else if (p[0] == '[' && p[len-1] == ']')
+            parse_group(p, len, parse, &error);
+        else if (!parse->seen_group)
             /* just ignore keys outside of groups */
             parse_error("Key found before group", parse, NULL);
-        else
+        else if (parse->in_entry)
             /* ignore errors in key-value pairs and continue */
-            parse_key_value(buf, len, parse, NULL);
-        ++parse->lineno;
-    }
+            parse_key_value(p, len, parse, NULL);
 
-    if (buf) g_free(buf);
+        p = eol + 1;
+    }
     return !error;
 }
 
-static gboolean parse_desktop_entry_value(gchar *key, const gchar *val,
-                                          ObtDDParse *parse, gboolean *error)
+/*! Parses the file at @path into the group.  Returns FALSE if it could not
+  be read or parsed. */
+static gboolean parse_file(const gchar *path, ObtDDParse *parse)
 {
-    ObtDDParseValue v, *pv;
-
-    switch (key[0]) {
-    case 'C':
-        switch (key[1]) {
-        case 'a': /* Categories */
-            if (strcmp(key+2, "tegories")) return FALSE;
-            v.type = OBT_DDPARSE_STRINGS; break;
-        case 'o': /* Comment */
-            if (strcmp(key+2, "mment")) return FALSE;
-            v.type = OBT_DDPARSE_LOCALESTRING; break;
-        default:
-            return FALSE;
-        }
-        break;
-    case 'E': /* Exec */
-        if (strcmp(key+1, "xec")) return FALSE;
-        v.type = OBT_DDPARSE_EXEC; parse->flags |= DE_EXEC; break;
-    case 'G': /* GenericName */
-        if (strcmp(key+1, "enericName")) return FALSE;
-        v.type = OBT_DDPARSE_LOCALESTRING; break;
-    case 'I': /* Icon */
-        if (strcmp(key+1, "con")) return FALSE;
-        v.type = OBT_DDPARSE_LOCALESTRING; break;
-    case 'H': /* Hidden */
-        if (strcmp(key+1, "idden")) return FALSE;
-        v.type = OBT_DDPARSE_BOOLEAN; break;
-    case 'M': /* MimeType */
-        if (strcmp(key+1, "imeType")) return FALSE;
-        v.type = OBT_DDPARSE_STRINGS; break;
-    case 'N':
-        switch (key[1]) {
-        case 'a': /* Name */
-            if (strcmp(key+2, "me")) return FALSE;
-            v.type = OBT_DDPARSE_LOCALESTRING; parse->flags |= DE_NAME; break;
-        case 'o':
-            switch (key[2]) {
-            case 'D': /* NoDisplay */
-                if (strcmp(key+3, "isplay")) return FALSE;
-                v.type = OBT_DDPARSE_BOOLEAN; break;
-            case 't': /* NotShowIn */
-                if (strcmp(key+3, "ShowIn")) return FALSE;
-                v.type = OBT_DDPARSE_STRINGS; break;
-            default:
-                return FALSE;
-            }
-            break;
-        default:
-            return FALSE;
-        }
-        break;
-    case 'P': /* Path */
-        if (strcmp(key+1, "ath")) return FALSE;
-        v.type = OBT_DDPARSE_STRING; break;
-    case 'S': /* Path */
-        if (key[1] == 't' && key[2] == 'a' && key[3] == 'r' &&
-            key[4] == 't' && key[5] == 'u' && key[6] == 'p')
-            switch (key[7]) {
-            case 'N': /* StartupNotify */
-                if (strcmp(key+8, "otify")) return FALSE;
-                v.type = OBT_DDPARSE_BOOLEAN; break;
-            case 'W': /* StartupWMClass */
-                if (strcmp(key+8, "MClass")) return FALSE;
-                v.type = OBT_DDPARSE_STRING; break;
-            default:
-                return FALSE;
-            }
-        else
-            return FALSE;
-        break;
-    case 'T':
-        switch (key[1]) {
-        case 'e': /* Terminal */
-            if (strcmp(key+2, "rminal")) return FALSE;
-            v.type = OBT_DDPARSE_BOOLEAN; break;
-        case 'r': /* TryExec */
-            if (strcmp(key+2, "yExec")) return FALSE;
-            v.type = OBT_DDPARSE_STRING; break;
-        case 'y': /* Type */
-            if (strcmp(key+2, "pe")) return FALSE;
-            v.type = OBT_DDPARSE_ENUM_TYPE; parse->flags |= DE_TYPE; break;
-        default:
-            return FALSE;
-        }
-        break;
-    case 'U': /* URL */
-        if (strcmp(key+1, "RL")) return FALSE;
-        v.type = OBT_DDPARSE_STRING; parse->flags |= DE_URL; break;
-    case 'V': /* MimeType */
-        if (strcmp(key+1, "ersion")) return FALSE;
-        v.type = OBT_DDPARSE_STRING; break;
-    default:
+    /* most .desktop files fit in here */
+    gchar stackbuf[8192];
+    struct stat st;
+    gchar *buf;
+    gsize got;
+    gboolean success;
+    gint fd;
+
+    if ((fd = open(path, O_RDONLY)) < 0)
+        return FALSE;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
         return FALSE;
     }
 
-    /* parse the value */
-    switch (v.type) {
-    case OBT_DDPARSE_EXEC: {
-        gchar *c, *m;
-        gboolean percent;
-        gboolean found;
+    /* the file is read rather than mapped, because a mapped file which is
+       truncated while it is parsed would kill us with SIGBUS */
+    if ((gsize)st.st_size < sizeof(stackbuf))
+        buf = stackbuf;
+    else
+        buf = g_malloc(st.st_size + 1);
 
-        v.value.string = parse_value_string(val, FALSE, FALSE, NULL,
-                                            parse, error);
-        g_assert(v.value.string);
-
-        /* an exec string can only contain one of the file/url-opening %'s */
-        percent = found = FALSE;
-        for (c = v.value.string; *c; ++c) {
-            if (percent) {
-                switch (*c) {
-                case 'f':
-                case 'F':
-                case 'u':
-                case 'U':
-                    if (found) {
-                        m = g_strdup_printf("Malformed Exec key, "
-                                            "extraneous %%%c", *c);
-                        parse_error(m, parse, error);
-                        g_free(m);
-                    }
-                    found = TRUE;
-                    break;
-                case 'd':
-                case 'D':
-                case 'n':
-                case 'N':
-                case 'v':
-                case 'm':
-                    m = g_strdup_printf("Malformed Exec key, "
-                                        "uses deprecated %%%c", *c);
-                    parse_error(m, parse, NULL); /* just a warning */
-                    g_free(m);
-                    break;
-                case 'i':
-                case 'c':
-                case 'k':
-                case '%':
-                    break;
-                default:
-                    m = g_strdup_printf("Malformed Exec key, "
-                                        "uses unknown %%%c", *c);
-                    parse_error(m, parse, NULL); /* just a warning */
-                    g_free(m);
-                }
-                percent = FALSE;
-            }
-            else if (*c == '%') percent = TRUE;
-        }
-        break;
-    }
-    case OBT_DDPARSE_STRING:
-        v.value.string = parse_value_string(val, FALSE, FALSE, NULL,
-                                            parse, error);
-        g_assert(v.value.string);
-        break;
-    case OBT_DDPARSE_LOCALESTRING:
-        v.value.string = parse_value_string(val, TRUE, FALSE, NULL,
-                                            parse, error);
-        g_assert(v.value.string);
-        break;
-    case OBT_DDPARSE_STRINGS:
-        v.value.strings.a = parse_value_strings(val, FALSE, &v.value.strings.n,
-                                                parse, error);
-        g_assert(v.value.strings.a);
-        g_assert(v.value.strings.n);
-        break;
-    case OBT_DDPARSE_LOCALESTRINGS:
-        v.value.strings.a = parse_value_strings(val, TRUE, &v.value.strings.n,
-                                                parse, error);
-        g_assert(v.value.strings.a);
-        g_assert(v.value.strings.n);
-        break;
-    case OBT_DDPARSE_BOOLEAN:
-        v.value.boolean = parse_value_boolean(val, parse, error);
-        break;
-    case OBT_DDPARSE_NUMERIC:
-        v.value.numeric = parse_value_numeric(val, parse, error);
-        break;
-    case OBT_DDPARSE_ENUM_TYPE:
-        if (val[0] == 'A' && strcmp(val+1, "pplication") == 0) {
-            v.value.enumerable = OBT_LINK_TYPE_APPLICATION;
-            parse->flags |= DE_TYPE_APPLICATION;
-        }
-        else if (val[0] == 'L' && strcmp(val+1, "ink") == 0) {
-            v.value.enumerable = OBT_LINK_TYPE_URL;
-            parse->flags |= DE_TYPE_LINK;
-        }
-        else if (val[0] == 'D' && strcmp(val+1, "irectory") == 0)
-            v.value.enumerable = OBT_LINK_TYPE_DIRECTORY;
-        else {
-            parse_error("Unknown Type", parse, error);
-            return FALSE;
-        }
-        break;
-    case OBT_DDPARSE_ENVIRONMENTS:
-        v.value.environments = parse_value_environments(val, parse, error);
-        break;
-    default:
-        g_assert_not_reached();
+    got = 0;
+    while (got < (gsize)st.st_size) {
+        gssize r = read(fd, buf + got, st.st_size - got);
+        if (r <= 0) break;
+        got += r;
     }
+    close(fd);
 
-    pv = g_slice_new(ObtDDParseValue);
-    *pv = v;
-    g_hash_table_insert(parse->group->key_hash, key, pv);
-    return TRUE;
+    success = parse_buffer(buf, got, parse);
+
+    if (buf != stackbuf)
+        g_free(buf);
+    return success;
 }
 
-GHashTable* obt_ddparse_file(const gchar *name, GSList *paths)
+ObtDDParseGroup* obt_ddparse_file(const gchar *name, GSList *paths)
 {
     ObtDDParse parse;
-    ObtDDParseGroup *desktop_entry;
     GSList *it;
-    FILE *f;
     gboolean success;
 
     parse.filename = NULL;
     parse.lineno = 0;
-    parse.group = NULL;
-    parse.group_hash = g_hash_table_new_full(g_str_hash,
-                                             g_str_equal,
-                                             NULL,
-                                             (GDestroyNotify)parse_group_free);
-
-    /* set up the groups (there's only one right now) */
-    desktop_entry = parse_group_new(g_strdup("Desktop Entry"),
-                                    parse_desktop_entry_value);
-    g_hash_table_insert(parse.group_hash, desktop_entry->name, desktop_entry);
+    parse.group = g_slice_new0(ObtDDParseGroup);
 
     success = FALSE;
     for (it = paths; it && !success; it = g_slist_next(it)) {
         gchar *path = g_strdup_printf("%s/%s", (char*)it->data, name);
-        if ((f = fopen(path, "r"))) {
-            parse.filename = path;
-            parse.lineno = 1;
-            parse.flags = 0;
-            if ((success = parse_file(f, &parse))) {
-                /* check that required keys exist */
-
-                if (!(parse.flags & DE_TYPE)) {
-                    g_warning("Missing Type key in %s", path);
-                    success = FALSE;
-                }
-                if (!(parse.flags & DE_NAME)) {
-                    g_warning("Missing Name key in %s", path);
-                    success = FALSE;
-                }
-                if (parse.flags & DE_TYPE_APPLICATION &&
-                    !(parse.flags & DE_EXEC))
-                {
-                    g_warning("Missing Exec key for Application in %s",
-                              path);
-                    success = FALSE;
-                }
-                else if (parse.flags & DE_TYPE_LINK && !(parse.flags & DE_URL))
-                {
-                    g_warning("Missing URL key for Link in %s", path);
-                    success = FALSE;
-                }
+
+        parse.filename = path;
+        parse.lineno = 1;
+        parse.flags = 0;
+        parse.seen_group = parse.in_entry = FALSE;
+        parse_group_clear(parse.group);
+        if ((success = parse_file(path, &parse))) {
+            /* check that required keys exist */
+
+            if (!(parse.flags & DE_TYPE)) {
+                g_warning("Missing Type key in %s", path);
+                success = FALSE;
+            }
+            if (!(parse.flags & DE_NAME)) {
+                g_warning("Missing Name key in %s", path);
+                success = FALSE;
+            }
+            if (parse.flags & DE_TYPE_APPLICATION &&
+                !(parse.flags & DE_EXEC))
+            {
+                g_warning("Missing Exec key for Application in %s",
+                          path);
+                success = FALSE;
+            }
+            else if (parse.flags & DE_TYPE_LINK && !(parse.flags & DE_URL))
+            {
+                g_warning("Missing URL key for Link in %s", path);
+                success = FALSE;
             }
-            fclose(f);
         }
         g_free(path);
     }
     if (!success) {
-        g_hash_table_destroy(parse.group_hash);
-        parse.group_hash = NULL;
+        obt_ddparse_group_free(parse.group);
+        parse.group = NULL;
+    }
+    return parse.group;
+}
+
+void obt_ddparse_group_free(ObtDDParseGroup *g)
+{
+    if (g) {
+        parse_group_clear(g);
+        g_slice_free(ObtDDParseGroup, g);
     }
-    return parse.group_hash;
 }
 
-GHashTable* obt_ddparse_group_keys(ObtDDParseGroup *g)
+ObtDDParseValue* obt_ddparse_group_value(ObtDDParseGroup *g,
+                                         ObtDDParseKey key)
 {
-    return g->key_hash;
+    g_return_val_if_fail(key < OBT_DDPARSE_NUM_KEYS, NULL);
+
+    if (!(g->present & (1 << key))) return NULL;
+    return &g->values[key];
 }
@@ -29,7 +29,6 @@ typedef enum {
     OBT_DDPARSE_BOOLEAN,
     OBT_DDPARSE_NUMERIC,
     OBT_DDPARSE_ENUM_TYPE,
-    OBT_DDPARSE_ENVIRONMENTS,
     OBT_DDPARSE_NUM_VALUE_TYPES
 } ObtDDParseValueType;
 
@@ -44,14 +43,42 @@ typedef struct _ObtDDParseValue {
         gboolean boolean;
         gfloat numeric;
         guint enumerable;
-        guint environments; /*!< A mask of flags from ObtLinkEnvMask */
     } value;
 } ObtDDParseValue;
 
-/* Returns a hash table where the keys are groups, and the values are
-   ObtDDParseGroups */
-GHashTable* obt_ddparse_file(const gchar *name, GSList *paths);
+/*! The keys in the [Desktop Entry] group which are read.  Any other keys
+  are skipped over without being looked at. */
+typedef enum {
+    OBT_DDPARSE_KEY_TYPE,
+    OBT_DDPARSE_KEY_NAME,
+    OBT_DDPARSE_KEY_GENERIC_NAME,
+    OBT_DDPARSE_KEY_NO_DISPLAY,
+    OBT_DDPARSE_KEY_COMMENT,
+    OBT_DDPARSE_KEY_ICON,
+    OBT_DDPARSE_KEY_HIDDEN,
+    OBT_DDPARSE_KEY_ONLY_SHOW_IN,
+    OBT_DDPARSE_KEY_NOT_SHOW_IN,
+    OBT_DDPARSE_KEY_TRY_EXEC,
+    OBT_DDPARSE_KEY_EXEC,
+    OBT_DDPARSE_KEY_PATH,
+    OBT_DDPARSE_KEY_TERMINAL,
+    OBT_DDPARSE_KEY_MIME_TYPE,
+    OBT_DDPARSE_KEY_CATEGORIES,
+    OBT_DDPARSE_KEY_STARTUP_NOTIFY,
+    OBT_DDPARSE_KEY_STARTUP_WM_CLASS,
+    OBT_DDPARSE_KEY_URL,
+    OBT_DDPARSE_NUM_KEYS
+} ObtDDParseKey;
+
+/*! Parses the .desktop file @name, from the first directory in @paths where
+  it can be parsed.  Returns its [Desktop Entry] group, or NULL if it could
+  not be parsed.  Free it with obt_ddparse_group_free(). */
+ObtDDParseGroup* obt_ddparse_file(const gchar *name, GSList *paths);
+
+void obt_ddparse_group_free(ObtDDParseGroup *g);
 
-/* Returns a hash table where the keys are "keys" in the .desktop file,
-   and the values are "values" in the .desktop file, for the group @g. */
-GHashTable* obt_ddparse_group_keys(ObtDDParseGroup *g);
+/*! Returns the value for the key in the group, or NULL if the key was not
+  in the file.  Strings in the value may be stolen by setting them to NULL
+  in it. */
+ObtDDParseValue* obt_ddparse_group_value(ObtDDParseGroup *g,
+                                         ObtDDParseKey key);
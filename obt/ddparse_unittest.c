@@ -0,0 +1,248 @@
+#include "obt/unittest_base.h"
+
+#include "obt/ddparse.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+
+/* The directory which the .desktop files are written to */
+static gchar *dir = NULL;
+static GSList *paths = NULL;
+
+static void setup() {
+    dir = g_build_filename(g_get_tmp_dir(), "obt-ddparse-XXXXXX", NULL);
+    g_assert(mkdtemp(dir));
+    paths = g_slist_append(NULL, dir);
+}
+
+static void teardown() {
+    GDir *d;
+    const gchar *name;
+
+    d = g_dir_open(dir, 0, NULL);
+    g_assert(d);
+    while ((name = g_dir_read_name(d))) {
+        gchar *f = g_build_filename(dir, name, NULL);
+        g_unlink(f);
+        g_free(f);
+    }
+    g_dir_close(d);
+    g_rmdir(dir);
+
+    g_slist_free(paths);
+    paths = NULL;
+    g_free(dir);
+    dir = NULL;
+}
+
+/* Writes a .desktop file, and parses it back in */
+static ObtDDParseGroup* parse(const gchar *contents) {
+    gchar *f;
+
+    f = g_build_filename(dir, "test.desktop", NULL);
+    g_assert(g_file_set_contents(f, contents, -1, NULL));
+    g_free(f);
+    return obt_ddparse_file("test.desktop", paths);
+}
+
+static const gchar* string(ObtDDParseGroup *g, ObtDDParseKey key) {
+    ObtDDParseValue *v = obt_ddparse_group_value(g, key);
+    return v ? v->value.string : NULL;
+}
+
+static void minimal() {
+    TEST_START();
+
+    ObtDDParseGroup *g;
+
+    g = parse("[Desktop Entry]\n"
+              "Type=Application\n"
+              "Name=Test\n"
+              "Exec=test %f\n");
+    EXPECT_BOOL_EQ(TRUE, g != NULL);
+    if (g) {
+        EXPECT_STRING_EQ("Test", string(g, OBT_DDPARSE_KEY_NAME));
+        EXPECT_STRING_EQ("test %f", string(g, OBT_DDPARSE_KEY_EXEC));
+        EXPECT_STRING_EQ(NULL, string(g, OBT_DDPARSE_KEY_COMMENT));
+        obt_ddparse_group_free(g);
+    }
+
+    /* An Application needs an Exec key */
+    g = parse("[Desktop Entry]\n"
+              "Type=Application\n"
+              "Name=Test\n");
+    EXPECT_BOOL_EQ(TRUE, g == NULL);
+
+    /* The [Desktop Entry] group has to come first */
+    g = parse("[Other Group]\n"
+              "Foo=Bar\n"
+              "[Desktop Entry]\n"
+              "Type=Application\n"
+              "Name=Test\n"
+              "Exec=test\n");
+    EXPECT_BOOL_EQ(TRUE, g == NULL);
+
+    TEST_END();
+}
+
+static void escapes() {
+    TEST_START();
+
+    ObtDDParseGroup *g;
+    ObtDDParseValue *v;
+
+    g = parse("[Desktop Entry]\n"
+              "Type=Application\n"
+              "Name=Te\\sst\n"
+              "Comment=a\\nb\\tc\\rd\\;e\\\\f\n"
+              "Exec=test\n"
+              "MimeType=text/plain;a\\;b;c\\\\;;\n");
+    EXPECT_BOOL_EQ(TRUE, g != NULL);
+    if (g) {
+        EXPECT_STRING_EQ("Te st", string(g, OBT_DDPARSE_KEY_NAME));
+        EXPECT_STRING_EQ("a\nb\tc\rd;e\\f",
+                         string(g, OBT_DDPARSE_KEY_COMMENT));
+
+        /* an escaped ; does not end a string in a list, and empty strings
+           are dropped */
+        v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_MIME_TYPE);
+        EXPECT_BOOL_EQ(TRUE, v != NULL);
+        if (v) {
+            EXPECT_UINT_EQ(3, (guint)v->value.strings.n);
+            EXPECT_STRING_EQ("text/plain", v->value.strings.a[0]);
+            EXPECT_STRING_EQ("a;b", v->value.strings.a[1]);
+            EXPECT_STRING_EQ("c\\", v->value.strings.a[2]);
+            EXPECT_STRING_EQ(NULL, v->value.strings.a[3]);
+        }
+        obt_ddparse_group_free(g);
+    }
+
+    /* a bad escape in one value does not stop the file being used */
+    g = parse("[Desktop Entry]\n"
+              "Type=Application\n"
+              "Name=Test\n"
+              "Comment=a\\qb\n"
+              "Exec=test\n");
+    EXPECT_BOOL_EQ(TRUE, g != NULL);
+    if (g) {
+        EXPECT_STRING_EQ("Test", string(g, OBT_DDPARSE_KEY_NAME));
+        obt_ddparse_group_free(g);
+    }
+
+    TEST_END();
+}
+
+static void localized_keys() {
+    TEST_START();
+
+    ObtDDParseGroup *g;
+
+    /* localized values are skipped, whichever side of the plain key they
+       are on */
+    g = parse("[Desktop Entry]\n"
+              "Type=Application\n"
+              "Name[de]=Prufung\n"
+              "Name=Test\n"
+              "Name[fr_FR@euro]=Essai\n"
+              "Comment[de]=Nur lokalisiert\n"
+              "Exec=test\n");
+    EXPECT_BOOL_EQ(TRUE, g != NULL);
+    if (g) {
+        EXPECT_STRING_EQ("Test", string(g, OBT_DDPARSE_KEY_NAME));
+        EXPECT_STRING_EQ(NULL, string(g, OBT_DDPARSE_KEY_COMMENT));
+        obt_ddparse_group_free(g);
+    }
+
+    /* a localized key does not stand in for a missing plain one */
+    g = parse("[Desktop Entry]\n"
+              "Type=Application\n"
+              "Name[de]=Prufung\n"
+              "Exec=test\n");
+    EXPECT_BOOL_EQ(TRUE, g == NULL);
+
+    TEST_END();
+}
+
+static void duplicates() {
+    TEST_START();
+
+    ObtDDParseGroup *g;
+
+    /* the first value for a key is used */
+    g = parse("[Desktop Entry]\n"
+              "Type=Application\n"
+              "Name=First\n"
+              "Name=Second\n"
+              "Exec=test\n");
+    EXPECT_BOOL_EQ(TRUE, g != NULL);
+    if (g) {
+        EXPECT_STRING_EQ("First", string(g, OBT_DDPARSE_KEY_NAME));
+        obt_ddparse_group_free(g);
+    }
+
+    /* a second [Desktop Entry] group makes the file invalid */
+    g = parse("[Desktop Entry]\n"
+              "Type=Application\n"
+              "Name=Test\n"
+              "Exec=test\n"
+              "[Desktop Entry]\n"
+              "Name=Again\n");
+    EXPECT_BOOL_EQ(TRUE, g == NULL);
+
+    /* other groups after it are ignored */
+    g = parse("[Desktop Entry]\n"
+              "Type=Application\n"
+              "Name=Test\n"
+              "Exec=test\n"
+              "[Desktop Action New]\n"
+              "Name=New\n"
+              "Exec=test --new\n");
+    EXPECT_BOOL_EQ(TRUE, g != NULL);
+    if (g) {
+        EXPECT_STRING_EQ("Test", string(g, OBT_DDPARSE_KEY_NAME));
+        EXPECT_STRING_EQ("test", string(g, OBT_DDPARSE_KEY_EXEC));
+        obt_ddparse_group_free(g);
+    }
+
+    TEST_END();
+}
+
+static void large_file() {
+    TEST_START();
+
+    ObtDDParseGroup *g;
+    GString *s;
+    gint i;
+
+    /* bigger than the buffer on the stack */
+    s = g_string_new("[Desktop Entry]\n"
+                     "Type=Application\n");
+    for (i = 0; s->len < 20000; ++i)
+        g_string_append_printf(s, "Name[x%d]=Localized name %d\n", i, i);
+    g_string_append(s, "Name=Test\n"
+                    "Exec=test\n");
+
+    g = parse(s->str);
+    EXPECT_BOOL_EQ(TRUE, g != NULL);
+    if (g) {
+        EXPECT_STRING_EQ("Test", string(g, OBT_DDPARSE_KEY_NAME));
+        EXPECT_STRING_EQ("test", string(g, OBT_DDPARSE_KEY_EXEC));
+        obt_ddparse_group_free(g);
+    }
+    g_string_free(s, TRUE);
+
+    TEST_END();
+}
+
+void run_ddparse_unittest() {
+    unittest_start_suite("ddparse");
+    setup();
+    minimal();
+    escapes();
+    localized_keys();
+    duplicates();
+    large_file();
+    teardown();
+    unittest_end_suite();
+}
@@ -51,9 +51,20 @@ gint     obt_display_extension_randr_basep;
 gboolean obt_display_extension_sync      = FALSE;
 gint     obt_display_extension_sync_basep;
 
+typedef struct _ObtErrorTrap ObtErrorTrap;
+
+/*! A range of request serial numbers whose errors are being ignored */
+struct _ObtErrorTrap {
+    gulong start;    /*!< The serial of the first request in the trap */
+    gulong end;      /*!< The serial after the last request in the trap, or 0
+                       while the trap is still open */
+    gint error_code; /*!< The first error generated inside the trap */
+};
+
 static gint xerror_handler(Display *d, XErrorEvent *e);
 
-static gboolean xerror_ignore = FALSE;
+/*! The error traps which may still receive errors, innermost first */
+static GSList *error_traps = NULL;
 
 gboolean obt_display_open(const char *display_name)
 {
@@ -134,32 +145,136 @@ void obt_display_close(void)
         xqueue_destroy();
         XCloseDisplay(obt_display);
     }
+    while (error_traps) {
+        g_slice_free(ObtErrorTrap, error_traps->data);
+        error_traps = g_slist_delete_link(error_traps, error_traps);
+    }
+}
+
+static ObtErrorTrap* trap_find(gulong serial)
+{
+    GSList *it;
+
+    for (it = error_traps; it; it = g_slist_next(it)) {
+        ObtErrorTrap *t = it->data;
+        if (serial >= t->start && (t->end == 0 || serial < t->end))
+            return t;
+    }
+    return NULL;
 }
 
 static gint xerror_handler(Display *d, XErrorEvent *e)
 {
+    ObtErrorTrap *t;
 #ifdef DEBUG
     gchar errtxt[128];
+#endif
+
+    t = trap_find(e->serial);
+    if (t && !t->error_code)
+        t->error_code = e->error_code;
 
+#ifdef DEBUG
     XGetErrorText(d, e->error_code, errtxt, 127);
-    if (!xerror_ignore) {
+    if (!t) {
         if (e->error_code == BadWindow)
             /*g_debug(_("X Error: %s\n"), errtxt)*/;
         else
             g_error("X Error: %s", errtxt);
     } else
-        g_debug("Ignoring XError code %d '%s'", e->error_code, errtxt);
+        g_debug("Ignoring XError code %d '%s' from request %d",
+                e->error_code, errtxt, e->request_code);
 #else
-    (void)d; (void)e;
+    (void)d;
 #endif
 
     obt_display_error_occured = TRUE;
     return 0;
 }
 
+/*! Forgets the closed traps which can not receive any more errors, because
+  the server has processed every request in them */
+static void trap_free_processed(void)
+{
+    GSList *it, *next;
+    gulong processed;
+
+    processed = LastKnownRequestProcessed(obt_display);
+    for (it = error_traps; it; it = next) {
+        ObtErrorTrap *t = it->data;
+
+        next = g_slist_next(it);
+        if (t->end && processed >= t->end) {
+            g_slice_free(ObtErrorTrap, t);
+            error_traps = g_slist_delete_link(error_traps, it);
+        }
+    }
+}
+
+void obt_display_trap_push(void)
+{
+    ObtErrorTrap *t;
+
+    trap_free_processed();
+
+    t = g_slice_new(ObtErrorTrap);
+    t->start = NextRequest(obt_display);
+    t->end = 0;
+    t->error_code = Success;
+    error_traps = g_slist_prepend(error_traps, t);
+}
+
+static ObtErrorTrap* trap_close(void)
+{
+    GSList *it;
+
+    /* find the innermost trap that is still open */
+    for (it = error_traps; it; it = g_slist_next(it)) {
+        ObtErrorTrap *t = it->data;
+        if (t->end == 0) {
+            t->end = NextRequest(obt_display);
+            return t;
+        }
+    }
+    g_assert_not_reached();
+    return NULL;
+}
+
+gint obt_display_trap_pop(void)
+{
+    ObtErrorTrap *t;
+    gint code;
+
+    t = trap_close();
+
+    /* only wait for the server if it might still send us an error for one
+       of the requests */
+    if (t->end > t->start &&
+        LastKnownRequestProcessed(obt_display) < t->end - 1)
+        XSync(obt_display, FALSE);
+
+    code = t->error_code;
+    error_traps = g_slist_remove(error_traps, t);
+    g_slice_free(ObtErrorTrap, t);
+    return code;
+}
+
+void obt_display_trap_pop_ignored(void)
+{
+    ObtErrorTrap *t;
+
+    t = trap_close();
+    /* it will be freed once the server has processed all of its requests */
+    if (t->end == t->start) {
+        error_traps = g_slist_remove(error_traps, t);
+        g_slice_free(ObtErrorTrap, t);
+    }
+}
+
 void obt_display_ignore_errors(gboolean ignore)
 {
-    XSync(obt_display, FALSE);
-    xerror_ignore = ignore;
-    if (ignore) obt_display_error_occured = FALSE;
+    if (ignore)
+        obt_display_trap_push();
+    else
+        obt_display_error_occured = obt_display_trap_pop() != Success;
 }
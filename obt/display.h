@@ -61,6 +61,23 @@ extern Display* obt_display;
 gboolean obt_display_open(const char *display_name);
 void     obt_display_close(void);
 
+/*! Starts ignoring X errors caused by the requests which follow, until the
+  matching pop.  This does not wait for the X server, errors are matched to
+  the trap by their request serial numbers whenever they arrive.  Traps can
+  be nested. */
+void     obt_display_trap_push(void);
+/*! Ends the innermost error trap, waiting for the X server if it has not
+  processed all of the trapped requests yet.
+  @return The first error code caused inside the trap, or Success
+*/
+gint     obt_display_trap_pop(void);
+/*! Ends the innermost error trap without waiting for the X server.  Errors
+  from the trapped requests are ignored whenever they arrive. */
+void     obt_display_trap_pop_ignored(void);
+
+/*! Ignores errors from the requests made while ignore is TRUE.  When it is
+  set back to FALSE, obt_display_error_occured is set if any error occured.
+  This is a trap push and pop. */
 void     obt_display_ignore_errors(gboolean ignore);
 
 #define  obt_root(screen) (RootWindow(obt_display, screen))
@@ -20,6 +20,7 @@
 #include "obt/ddparse.h"
 #include "obt/paths.h"
 #include <glib.h>
+#include <string.h>
 
 struct _ObtLink {
     guint ref;
@@ -33,14 +34,18 @@ struct _ObtLink {
     gchar *generic; /*!< Generic name for the object (eg Web Browser) */
     gchar *comment; /*!< Comment/description to display for the object */
     gchar *icon; /*!< Name/path for an icon for the object */
-    guint env_required; /*!< The environments that must be present to use this
-                          link. */
-    guint env_restricted; /*!< The environments that must _not_ be present to
-                            use this link. */
+    gchar **env_required; /*!< The environments that must be present to use
+                            this link, or NULL for any environment */
+    gchar **env_restricted; /*!< The environments that must _not_ be present
+                              to use this link, or NULL for none */
 
     union _ObtLinkData {
         struct _ObtLinkApp {
             gchar *exec; /*!< Executable to run for the app */
+            gchar *tryexec; /*!< Program which must be installed for the app
+                              to be shown */
+            gboolean runnable; /*!< FALSE if the TryExec program is not
+                                 installed */
             gchar *wdir; /*!< Working dir to run the app in */
             gboolean term; /*!< Run the app in a terminal or not */
             ObtLinkAppOpen open;
@@ -66,52 +71,48 @@ ObtLink* obt_link_from_ddfile(const gchar *ddname, GSList *paths,
                               ObtPaths *p)
 {
     ObtLink *link;
-    GHashTable *groups, *keys;
     ObtDDParseGroup *g;
     ObtDDParseValue *v;
 
-    /* parse the file, and get a hash table of the groups */
-    groups = obt_ddparse_file(ddname, paths);
-    if (!groups) return NULL; /* parsing failed */
-    /* grab the Desktop Entry group */
-    g = g_hash_table_lookup(groups, "Desktop Entry");
-    g_assert(g != NULL);
-    /* grab the keys that appeared in the Desktop Entry group */
-    keys = obt_ddparse_group_keys(g);
+    /* parse the file, and get the Desktop Entry group */
+    g = obt_ddparse_file(ddname, paths);
+    if (!g) return NULL; /* parsing failed */
 
     /* build the ObtLink (we steal all strings from the parser) */
     link = g_slice_new0(ObtLink);
     link->ref = 1;
     link->display = TRUE;
 
-    v = g_hash_table_lookup(keys, "Type");
+    v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_TYPE);
     g_assert(v);
     link->type = v->value.enumerable;
 
-    if ((v = g_hash_table_lookup(keys, "Hidden")))
+    v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_NAME);
+    g_assert(v);
+    link->name = v->value.string, v->value.string = NULL;
+
+    if ((v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_HIDDEN)))
         link->deleted = v->value.boolean;
 
-    if ((v = g_hash_table_lookup(keys, "NoDisplay")))
+    if ((v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_NO_DISPLAY)))
         link->display = !v->value.boolean;
 
-    if ((v = g_hash_table_lookup(keys, "GenericName")))
+    if ((v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_GENERIC_NAME)))
         link->generic = v->value.string, v->value.string = NULL;
 
-    if ((v = g_hash_table_lookup(keys, "Comment")))
+    if ((v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_COMMENT)))
         link->comment = v->value.string, v->value.string = NULL;
 
-    if ((v = g_hash_table_lookup(keys, "Icon")))
+    if ((v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_ICON)))
         link->icon = v->value.string, v->value.string = NULL;
 
-    if ((v = g_hash_table_lookup(keys, "OnlyShowIn")))
-        link->env_required = v->value.environments;
-    else
-        link->env_required = 0;
+    /* the environments are kept as they are written, so that ones which
+       aren't known here can still be matched by name */
+    if ((v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_ONLY_SHOW_IN)))
+        link->env_required = v->value.strings.a, v->value.strings.a = NULL;
 
-    if ((v = g_hash_table_lookup(keys, "NotShowIn")))
-        link->env_restricted = v->value.environments;
-    else
-        link->env_restricted = 0;
+    if ((v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_NOT_SHOW_IN)))
+        link->env_restricted = v->value.strings.a, v->value.strings.a = NULL;
 
     /* type-specific keys */
 
@@ -119,7 +120,7 @@ ObtLink* obt_link_from_ddfile(const gchar *ddname, GSList *paths,
         gchar *c;
         gboolean percent;
 
-        v = g_hash_table_lookup(keys, "Exec");
+        v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_EXEC);
         g_assert(v);
         link->d.app.exec = v->value.string;
         v->value.string = NULL;
@@ -140,37 +141,39 @@ ObtLink* obt_link_from_ddfile(const gchar *ddname, GSList *paths,
             else if (*c == '%') percent = TRUE;
         }
 
-        if ((v = g_hash_table_lookup(keys, "TryExec"))) {
-            /* XXX spawn a thread to check TryExec? */
-            link->display = link->display &&
-                obt_paths_try_exec(p, v->value.string);
+        link->d.app.runnable = TRUE;
+        if ((v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_TRY_EXEC))) {
+            /* steal the string */
+            link->d.app.tryexec = v->value.string;
+            v->value.string = NULL;
+            link->d.app.runnable = obt_paths_try_exec(p, link->d.app.tryexec);
         }
 
-        if ((v = g_hash_table_lookup(keys, "Path"))) {
+        if ((v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_PATH))) {
             /* steal the string */
             link->d.app.wdir = v->value.string;
             v->value.string = NULL;
         }
 
-        if ((v = g_hash_table_lookup(keys, "Terminal")))
+        if ((v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_TERMINAL)))
             link->d.app.term = v->value.boolean;
 
-        if ((v = g_hash_table_lookup(keys, "StartupNotify")))
+        if ((v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_STARTUP_NOTIFY)))
             link->d.app.startup = v->value.boolean ?
                 OBT_LINK_APP_STARTUP_PROTOCOL_SUPPORT :
                 OBT_LINK_APP_STARTUP_NO_SUPPORT;
         else {
             link->d.app.startup = OBT_LINK_APP_STARTUP_LEGACY_SUPPORT;
-            if ((v = g_hash_table_lookup(keys, "StartupWMClass"))) {
+            v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_STARTUP_WM_CLASS);
+            if (v) {
                 /* steal the string */
                 link->d.app.startup_wmclass = v->value.string;
                 v->value.string = NULL;
             }
         }
 
-        if ((v = g_hash_table_lookup(keys, "Categories"))) {
+        if ((v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_CATEGORIES))) {
             gulong i;
-            gchar *end;
 
             link->d.app.categories = g_new(GQuark, v->value.strings.n);
             link->d.app.n_categories = v->value.strings.n;
@@ -178,11 +181,10 @@ ObtLink* obt_link_from_ddfile(const gchar *ddname, GSList *paths,
             for (i = 0; i < v->value.strings.n; ++i) {
                 link->d.app.categories[i] =
                     g_quark_from_string(v->value.strings.a[i]);
-                c = end = end+1; /* next */
             }
         }
 
-        if ((v = g_hash_table_lookup(keys, "MimeType"))) {
+        if ((v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_MIME_TYPE))) {
             /* steal the string array */
             link->d.app.mime = v->value.strings.a;
             v->value.strings.a = NULL;
@@ -190,14 +192,14 @@ ObtLink* obt_link_from_ddfile(const gchar *ddname, GSList *paths,
         }
     }
     else if (link->type == OBT_LINK_TYPE_URL) {
-        v = g_hash_table_lookup(keys, "URL");
+        v = obt_ddparse_group_value(g, OBT_DDPARSE_KEY_URL);
         g_assert(v);
         link->d.url.addr = v->value.string;
         v->value.string = NULL;
     }
 
     /* destroy the parsing info */
-    g_hash_table_destroy(groups);
+    obt_ddparse_group_free(g);
 
     return link;
 }
@@ -214,8 +216,11 @@ void obt_link_unref(ObtLink *dd)
         g_free(dd->generic);
         g_free(dd->comment);
         g_free(dd->icon);
+        g_strfreev(dd->env_required);
+        g_strfreev(dd->env_restricted);
         if (dd->type == OBT_LINK_TYPE_APPLICATION) {
             g_free(dd->d.app.exec);
+            g_free(dd->d.app.tryexec);
             g_free(dd->d.app.wdir);
             g_strfreev(dd->d.app.mime);
             g_free(dd->d.app.categories);
@@ -236,3 +241,251 @@ const GQuark* obt_link_app_categories(ObtLink *e, gulong *n)
     *n = e->d.app.n_categories;
     return e->d.app.categories;
 }
+
+gboolean obt_link_deleted(ObtLink *e)
+{
+    return e->deleted;
+}
+
+ObtLinkType obt_link_type(ObtLink *e)
+{
+    return e->type;
+}
+
+gboolean obt_link_display(ObtLink *e, const gchar *env)
+{
+    if (!e->display) return FALSE;
+    if (e->type == OBT_LINK_TYPE_APPLICATION && !e->d.app.runnable)
+        return FALSE;
+    return obt_link_show_in(e, env);
+}
+
+/*! Returns TRUE if any of the environments in the semicolon separated list
+  @env is in @list */
+static gboolean env_listed(gchar **list, const gchar *env)
+{
+    const gchar *s, *e;
+    gchar **it;
+
+    for (s = env; s && *s; s = *e ? e + 1 : e) {
+        if (!(e = strchr(s, ';')))
+            e = s + strlen(s);
+
+        for (it = list; *it; ++it)
+            if (e > s && !strncmp(*it, s, e - s) && (*it)[e - s] == '\0')
+                return TRUE;
+    }
+    return FALSE;
+}
+
+gboolean obt_link_show_in(ObtLink *e, const gchar *env)
+{
+    if (e->env_required && !env_listed(e->env_required, env)) return FALSE;
+    if (e->env_restricted && env_listed(e->env_restricted, env)) return FALSE;
+    return TRUE;
+}
+
+const gchar* obt_link_name(ObtLink *e)
+{
+    return e->name;
+}
+
+const gchar* obt_link_generic_name(ObtLink *e)
+{
+    return e->generic;
+}
+
+const gchar* obt_link_comment(ObtLink *e)
+{
+    return e->comment;
+}
+
+const gchar* obt_link_icon(ObtLink *e)
+{
+    return e->icon;
+}
+
+const gchar *obt_link_url_path(ObtLink *e)
+{
+    g_return_val_if_fail(e->type == OBT_LINK_TYPE_URL, NULL);
+
+    return e->d.url.addr;
+}
+
+const gchar* obt_link_app_executable(ObtLink *e)
+{
+    g_return_val_if_fail(e->type == OBT_LINK_TYPE_APPLICATION, NULL);
+
+    return e->d.app.exec;
+}
+
+const gchar* obt_link_app_path(ObtLink *e)
+{
+    g_return_val_if_fail(e->type == OBT_LINK_TYPE_APPLICATION, NULL);
+
+    return e->d.app.wdir;
+}
+
+const gchar* obt_link_app_try_exec(ObtLink *e)
+{
+    g_return_val_if_fail(e->type == OBT_LINK_TYPE_APPLICATION, NULL);
+
+    return e->d.app.tryexec;
+}
+
+gboolean obt_link_app_runnable(ObtLink *e)
+{
+    g_return_val_if_fail(e->type == OBT_LINK_TYPE_APPLICATION, FALSE);
+
+    return e->d.app.runnable;
+}
+
+gboolean obt_link_app_run_in_terminal(ObtLink *e)
+{
+    g_return_val_if_fail(e->type == OBT_LINK_TYPE_APPLICATION, FALSE);
+
+    return e->d.app.term;
+}
+
+const gchar*const* obt_link_app_mime_types(ObtLink *e)
+{
+    g_return_val_if_fail(e->type == OBT_LINK_TYPE_APPLICATION, NULL);
+
+    return (const gchar*const*)e->d.app.mime;
+}
+
+ObtLinkAppOpen obt_link_app_open(ObtLink *e)
+{
+    g_return_val_if_fail(e->type == OBT_LINK_TYPE_APPLICATION, 0);
+
+    return e->d.app.open;
+}
+
+ObtLinkAppStartup obt_link_app_startup_notify(ObtLink *e)
+{
+    g_return_val_if_fail(e->type == OBT_LINK_TYPE_APPLICATION,
+                         OBT_LINK_APP_STARTUP_NO_SUPPORT);
+
+    return e->d.app.startup;
+}
+
+const gchar* obt_link_app_startup_wmclass(ObtLink *e)
+{
+    g_return_val_if_fail(e->type == OBT_LINK_TYPE_APPLICATION, NULL);
+
+    return e->d.app.startup_wmclass;
+}
+
+static void save_string(GKeyFile *k, const gchar *group, const gchar *key,
+                        const gchar *value)
+{
+    if (value) g_key_file_set_string(k, group, key, value);
+}
+
+void obt_link_save(ObtLink *e, GKeyFile *k, const gchar *group)
+{
+    g_key_file_set_integer(k, group, "Type", e->type);
+    save_string(k, group, "Name", e->name);
+    save_string(k, group, "GenericName", e->generic);
+    save_string(k, group, "Comment", e->comment);
+    save_string(k, group, "Icon", e->icon);
+    g_key_file_set_boolean(k, group, "Display", e->display);
+    g_key_file_set_boolean(k, group, "Deleted", e->deleted);
+    if (e->env_required)
+        g_key_file_set_string_list(k, group, "OnlyShowIn",
+                                   (const gchar*const*)e->env_required,
+                                   g_strv_length(e->env_required));
+    if (e->env_restricted)
+        g_key_file_set_string_list(k, group, "NotShowIn",
+                                   (const gchar*const*)e->env_restricted,
+                                   g_strv_length(e->env_restricted));
+
+    if (e->type == OBT_LINK_TYPE_APPLICATION) {
+        save_string(k, group, "Exec", e->d.app.exec);
+        save_string(k, group, "TryExec", e->d.app.tryexec);
+        save_string(k, group, "Path", e->d.app.wdir);
+        g_key_file_set_boolean(k, group, "Terminal", e->d.app.term);
+        g_key_file_set_integer(k, group, "Open", e->d.app.open);
+        g_key_file_set_integer(k, group, "Startup", e->d.app.startup);
+        save_string(k, group, "StartupWMClass", e->d.app.startup_wmclass);
+        if (e->d.app.mime)
+            g_key_file_set_string_list(k, group, "MimeType",
+                                       (const gchar*const*)e->d.app.mime,
+                                       g_strv_length(e->d.app.mime));
+        if (e->d.app.n_categories) {
+            const gchar **c;
+            gulong i;
+
+            c = g_new(const gchar*, e->d.app.n_categories);
+            for (i = 0; i < e->d.app.n_categories; ++i)
+                c[i] = g_quark_to_string(e->d.app.categories[i]);
+            g_key_file_set_string_list(k, group, "Categories", c,
+                                       e->d.app.n_categories);
+            g_free(c);
+        }
+    }
+    else if (e->type == OBT_LINK_TYPE_URL)
+        save_string(k, group, "URL", e->d.url.addr);
+}
+
+ObtLink* obt_link_load(GKeyFile *k, const gchar *group, ObtPaths *p)
+{
+    ObtLink *link;
+
+    link = g_slice_new0(ObtLink);
+    link->ref = 1;
+    link->type = g_key_file_get_integer(k, group, "Type", NULL);
+    link->name = g_key_file_get_string(k, group, "Name", NULL);
+    link->generic = g_key_file_get_string(k, group, "GenericName", NULL);
+    link->comment = g_key_file_get_string(k, group, "Comment", NULL);
+    link->icon = g_key_file_get_string(k, group, "Icon", NULL);
+    link->display = g_key_file_get_boolean(k, group, "Display", NULL);
+    link->deleted = g_key_file_get_boolean(k, group, "Deleted", NULL);
+    link->env_required = g_key_file_get_string_list(k, group, "OnlyShowIn",
+                                                    NULL, NULL);
+    link->env_restricted = g_key_file_get_string_list(k, group, "NotShowIn",
+                                                      NULL, NULL);
+
+    if (link->type == OBT_LINK_TYPE_APPLICATION) {
+        gchar **c;
+        gsize i, n;
+
+        link->d.app.exec = g_key_file_get_string(k, group, "Exec", NULL);
+        link->d.app.tryexec = g_key_file_get_string(k, group, "TryExec",
+                                                    NULL);
+        link->d.app.wdir = g_key_file_get_string(k, group, "Path", NULL);
+        link->d.app.term = g_key_file_get_boolean(k, group, "Terminal",
+                                                  NULL);
+        link->d.app.open = g_key_file_get_integer(k, group, "Open", NULL);
+        link->d.app.startup = g_key_file_get_integer(k, group, "Startup",
+                                                     NULL);
+        link->d.app.startup_wmclass =
+            g_key_file_get_string(k, group, "StartupWMClass", NULL);
+        link->d.app.mime = g_key_file_get_string_list(k, group, "MimeType",
+                                                      NULL, NULL);
+
+        c = g_key_file_get_string_list(k, group, "Categories", &n, NULL);
+        if (c) {
+            link->d.app.categories = g_new(GQuark, n);
+            link->d.app.n_categories = n;
+            for (i = 0; i < n; ++i)
+                link->d.app.categories[i] = g_quark_from_string(c[i]);
+            g_strfreev(c);
+        }
+
+        /* programs may have been installed or removed since it was saved */
+        link->d.app.runnable = !link->d.app.tryexec ||
+            obt_paths_try_exec(p, link->d.app.tryexec);
+    }
+    else if (link->type == OBT_LINK_TYPE_URL)
+        link->d.url.addr = g_key_file_get_string(k, group, "URL", NULL);
+
+    if (!link->name ||
+        (link->type == OBT_LINK_TYPE_APPLICATION && !link->d.app.exec) ||
+        (link->type == OBT_LINK_TYPE_URL && !link->d.url.addr))
+    {
+        obt_link_unref(link);
+        link = NULL;
+    }
+    return link;
+}
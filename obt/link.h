@@ -79,11 +79,19 @@ ObtLinkType obt_link_type (ObtLink *e);
 /*! Returns TRUE if the .desktop file should be displayed to users, given the
     current environment.  If FALSE, the .desktop file should not be showed.
     This also uses the TryExec option if it is present.
-    @env A semicolon-deliminated list of environemnts.  Can be one or more of:
-         GNOME, KDE, ROX, XFCE.  Other environments not listed here may also
-         be supported.  This can be null also if not listing any environment. */
+    @env A semicolon-deliminated list of environemnts, such as GNOME, KDE,
+         ROX, XFCE.  Any name can be used, and it is compared with the names
+         in the OnlyShowIn and NotShowIn keys.  This can be null also if not
+         listing any environment. */
 gboolean obt_link_display(ObtLink *e, const gchar *env);
 
+/*! Returns TRUE if the OnlyShowIn and NotShowIn keys of the .desktop file
+    allow it to be used in the given environment.  Unlike
+    obt_link_display(), this ignores the NoDisplay and TryExec keys.
+    @env A semicolon-deliminated list of environments, as for
+         obt_link_display(). */
+gboolean obt_link_show_in(ObtLink *e, const gchar *env);
+
 const gchar* obt_link_name           (ObtLink *e);
 const gchar* obt_link_generic_name   (ObtLink *e);
 const gchar* obt_link_comment        (ObtLink *e);
@@ -99,6 +107,11 @@ const gchar *obt_link_url_path(ObtLink *e);
 const gchar*  obt_link_app_executable      (ObtLink *e);
 /*! Returns the path in which the application should be run */
 const gchar*  obt_link_app_path            (ObtLink *e);
+/*! Returns the program which must be installed for the application to be
+    used, or NULL if there is none */
+const gchar*  obt_link_app_try_exec        (ObtLink *e);
+/*! Returns FALSE if the TryExec program is not installed */
+gboolean      obt_link_app_runnable        (ObtLink *e);
 gboolean      obt_link_app_run_in_terminal (ObtLink *e);
 const gchar*const* obt_link_app_mime_types      (ObtLink *e);
 const GQuark* obt_link_app_categories      (ObtLink *e, gulong *n);
@@ -110,6 +123,14 @@ ObtLinkAppOpen obt_link_app_open(ObtLink *e);
 ObtLinkAppStartup obt_link_app_startup_notify(ObtLink *e);
 const gchar* obt_link_app_startup_wmclass(ObtLink *e);
 
+/*! Writes the ObtLink into a group of a GKeyFile, so that it can be read back
+    with obt_link_load() without parsing the .desktop file again. */
+void obt_link_save(ObtLink *e, GKeyFile *k, const gchar *group);
+/*! Reads an ObtLink which was written with obt_link_save().  The TryExec
+    program is looked for again, as it may have been installed or removed
+    since.  Returns NULL if the group does not hold a valid ObtLink. */
+ObtLink* obt_link_load(GKeyFile *k, const gchar *group, struct _ObtPaths *p);
+
 
 G_END_DECLS
 
@@ -0,0 +1,609 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   obt/linkbase.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox developers
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#include "obt/linkbase.h"
+#include "obt/link.h"
+#include "obt/paths.h"
+#include "obt/watch.h"
+
+#ifdef HAVE_SYS_STAT_H
+#  include <sys/stat.h>
+#endif
+#ifdef HAVE_STRING_H
+#  include <string.h>
+#endif
+
+/*! Bump this when the format of the cache file changes */
+#define CACHE_VERSION 3
+#define CACHE_GROUP "Openbox LinkBase"
+/*! How long to wait after a change before saving the cache, so that many
+  changes at once (such as from a package manager) only save it once */
+#define SAVE_DELAY 10
+
+typedef struct _ObtLinkBaseEntry ObtLinkBaseEntry;
+
+struct _ObtLinkBaseEntry {
+    ObtLink *link;
+    gint priority; /*!< The index in the ObtLinkBase's dirs of the directory
+                     that the .desktop file was found in */
+    gchar *relpath; /*!< The path to the .desktop file in that directory */
+};
+
+struct _ObtLinkBase {
+    gint ref;
+
+    ObtPaths *paths;
+    gchar *locale;
+    gchar *cache_path;
+    /*! The directories to search for .desktop files, from highest to lowest
+      priority */
+    GSList *dirs;
+    /*! Maps a desktop file id to the ObtLinkBaseEntry for the highest priority
+      .desktop file with that id */
+    GHashTable *links;
+    /*! Maps a category GQuark to a GSList of the ObtLinks in it */
+    GHashTable *categories;
+
+    ObtWatch *watch;
+    guint save_id;
+    ObtLinkBaseUpdateFunc update_func;
+    gpointer update_data;
+};
+
+static void entry_free(ObtLinkBaseEntry *e)
+{
+    obt_link_unref(e->link);
+    g_free(e->relpath);
+    g_slice_free(ObtLinkBaseEntry, e);
+}
+
+/*! The desktop file id is the path below the applications directory, with
+  each '/' replaced by a '-' */
+static gchar* make_id(const gchar *relpath)
+{
+    gchar *id, *c;
+
+    id = g_strdup(relpath);
+    for (c = id; *c; ++c)
+        if (*c == G_DIR_SEPARATOR) *c = '-';
+    return id;
+}
+
+static void category_add(ObtLinkBase *lb, ObtLink *link)
+{
+    const GQuark *c;
+    gulong i, n;
+
+    if (obt_link_deleted(link) ||
+        obt_link_type(link) != OBT_LINK_TYPE_APPLICATION)
+        return;
+
+    c = obt_link_app_categories(link, &n);
+    for (i = 0; i < n; ++i) {
+        gpointer key = GUINT_TO_POINTER(c[i]);
+        GSList *list;
+
+        list = g_hash_table_lookup(lb->categories, key);
+        g_hash_table_insert(lb->categories, key,
+                            g_slist_prepend(list, link));
+    }
+}
+
+static void category_remove(ObtLinkBase *lb, ObtLink *link)
+{
+    const GQuark *c;
+    gulong i, n;
+
+    if (obt_link_deleted(link) ||
+        obt_link_type(link) != OBT_LINK_TYPE_APPLICATION)
+        return;
+
+    c = obt_link_app_categories(link, &n);
+    for (i = 0; i < n; ++i) {
+        gpointer key = GUINT_TO_POINTER(c[i]);
+        GSList *list;
+
+        list = g_hash_table_lookup(lb->categories, key);
+        list = g_slist_remove(list, link);
+        if (list)
+            g_hash_table_insert(lb->categories, key, list);
+        else
+            g_hash_table_remove(lb->categories, key);
+    }
+}
+
+static void category_free(gpointer key, gpointer list, gpointer data)
+{
+    g_slist_free(list);
+}
+
+/*! Adds an ObtLink to the index, replacing any ObtLink with the same id */
+static void set_entry(ObtLinkBase *lb, gchar *id, ObtLink *link,
+                      gint priority, const gchar *relpath)
+{
+    ObtLinkBaseEntry *e;
+
+    if ((e = g_hash_table_lookup(lb->links, id))) {
+        category_remove(lb, e->link);
+        g_hash_table_remove(lb->links, id);
+    }
+
+    e = g_slice_new(ObtLinkBaseEntry);
+    e->link = link;
+    e->priority = priority;
+    e->relpath = g_strdup(relpath);
+    g_hash_table_insert(lb->links, id, e);
+    category_add(lb, link);
+}
+
+/*! Finds the .desktop files in a directory and its subdirectories.
+  @param files The paths of the .desktop files, relative to @dir, are
+               appended to this list.
+  @param stamp Is updated from the modification time and size of each file,
+               so that any change to the .desktop files changes it.
+*/
+static void scan_dir(const gchar *dir, const gchar *rel, GSList **files,
+                     guint *stamp)
+{
+    GDir *d;
+    const gchar *name;
+    gchar *path;
+
+    path = g_build_filename(dir, rel, NULL);
+    if (!(d = g_dir_open(path, 0, NULL))) {
+        g_free(path);
+        return;
+    }
+
+    while ((name = g_dir_read_name(d))) {
+        gchar *sub, *full;
+        struct stat st;
+
+        sub = rel[0] ? g_build_filename(rel, name, NULL) : g_strdup(name);
+        full = g_build_filename(path, name, NULL);
+        if (stat(full, &st) == 0) {
+            if (S_ISDIR(st.st_mode))
+                scan_dir(dir, sub, files, stamp);
+            else if (g_str_has_suffix(name, ".desktop")) {
+                /* a sum doesn't depend on the order that files are read */
+                *stamp += g_str_hash(sub) ^
+                    ((guint)st.st_mtime * 2654435761u) ^ (guint)st.st_size;
+                *files = g_slist_prepend(*files, sub);
+                sub = NULL;
+            }
+        }
+        g_free(sub);
+        g_free(full);
+    }
+
+    g_dir_close(d);
+    g_free(path);
+}
+
+/*! Parses all the .desktop files found in each directory */
+static void build(ObtLinkBase *lb, GSList **files)
+{
+    GSList *it, *fit;
+    gint i;
+
+    for (i = 0, it = lb->dirs; it; ++i, it = g_slist_next(it)) {
+        GSList one = { it->data, NULL };
+
+        for (fit = files[i]; fit; fit = g_slist_next(fit)) {
+            gchar *id;
+            ObtLink *link;
+
+            id = make_id(fit->data);
+            /* a higher priority directory had a file with the same id */
+            if (g_hash_table_lookup(lb->links, id)) {
+                g_free(id);
+                continue;
+            }
+
+            if ((link = obt_link_from_ddfile(fit->data, &one, lb->paths)))
+                set_entry(lb, id, link, i, fit->data);
+            else
+                g_free(id);
+        }
+    }
+}
+
+static gint* cache_stamps(GKeyFile *k, gsize n)
+{
+    gint *stamps;
+    gsize len;
+
+    stamps = g_key_file_get_integer_list(k, CACHE_GROUP, "Stamps", &len,
+                                         NULL);
+    if (stamps && len != n) {
+        g_free(stamps);
+        stamps = NULL;
+    }
+    return stamps;
+}
+
+/*! Loads the index from the cache file, if it was made from the same
+  directories and none of the .desktop files in them have changed since */
+static gboolean load(ObtLinkBase *lb, const guint *stamps, gsize n)
+{
+    GKeyFile *k;
+    gchar **groups, **dirs, *locale;
+    gint version, *cached;
+    gsize i, ndirs;
+    GSList *it;
+    gboolean ok;
+
+    k = g_key_file_new();
+    if (!g_key_file_load_from_file(k, lb->cache_path, G_KEY_FILE_NONE,
+                                   NULL))
+    {
+        g_key_file_free(k);
+        return FALSE;
+    }
+
+    version = g_key_file_get_integer(k, CACHE_GROUP, "Version", NULL);
+    locale = g_key_file_get_string(k, CACHE_GROUP, "Locale", NULL);
+    dirs = g_key_file_get_string_list(k, CACHE_GROUP, "Directories", &ndirs,
+                                      NULL);
+    cached = cache_stamps(k, n);
+
+    ok = version == CACHE_VERSION && cached && dirs && ndirs == n &&
+        !strcmp(locale ? locale : "", lb->locale ? lb->locale : "");
+    for (i = 0, it = lb->dirs; ok && it; ++i, it = g_slist_next(it))
+        ok = !strcmp(dirs[i], it->data) && (guint)cached[i] == stamps[i];
+
+    g_free(locale);
+    g_strfreev(dirs);
+    g_free(cached);
+
+    if (ok) {
+        groups = g_key_file_get_groups(k, NULL);
+        for (i = 0; groups[i]; ++i) {
+            ObtLink *link;
+            gchar *relpath, *id;
+            gint priority;
+
+            if (!strcmp(groups[i], CACHE_GROUP)) continue;
+
+            relpath = g_key_file_get_string(k, groups[i], "RelPath", NULL);
+            priority = g_key_file_get_integer(k, groups[i], "Priority",
+                                              NULL);
+            link = obt_link_load(k, groups[i], lb->paths);
+            id = g_uri_unescape_string(groups[i], NULL);
+            if (link && relpath && id)
+                set_entry(lb, id, link, priority, relpath);
+            else {
+                if (link) obt_link_unref(link);
+                g_free(id);
+            }
+            g_free(relpath);
+        }
+        g_strfreev(groups);
+    }
+
+    g_key_file_free(k);
+    return ok;
+}
+
+/*! Writes the index to the cache file.
+  @param stamps The stamps from scan_dir() for each directory, or NULL to
+                look at the directories again.
+*/
+static void save(ObtLinkBase *lb, const guint *stamps)
+{
+    GKeyFile *k;
+    GHashTableIter iter;
+    gpointer key, val;
+    const gchar **dirs;
+    gint *istamps;
+    GSList *it;
+    gint i, n;
+    gchar *data, *dir;
+    gsize len;
+
+    n = g_slist_length(lb->dirs);
+    dirs = g_new(const gchar*, n);
+    istamps = g_new(gint, n);
+    for (i = 0, it = lb->dirs; it; ++i, it = g_slist_next(it)) {
+        guint stamp = 0;
+
+        if (stamps)
+            stamp = stamps[i];
+        else {
+            GSList *files = NULL;
+
+            scan_dir(it->data, "", &files, &stamp);
+            g_slist_foreach(files, (GFunc)g_free, NULL);
+            g_slist_free(files);
+        }
+        dirs[i] = it->data;
+        istamps[i] = (gint)stamp;
+    }
+
+    k = g_key_file_new();
+    g_key_file_set_integer(k, CACHE_GROUP, "Version", CACHE_VERSION);
+    g_key_file_set_string(k, CACHE_GROUP, "Locale",
+                          lb->locale ? lb->locale : "");
+    g_key_file_set_string_list(k, CACHE_GROUP, "Directories", dirs, n);
+    g_key_file_set_integer_list(k, CACHE_GROUP, "Stamps", istamps, n);
+    g_free(dirs);
+    g_free(istamps);
+
+    g_hash_table_iter_init(&iter, lb->links);
+    while (g_hash_table_iter_next(&iter, &key, &val)) {
+        ObtLinkBaseEntry *e = val;
+        gchar *group;
+
+        /* ids can have characters that a group name can't, such as [ and ],
+           so they are escaped */
+        group = g_uri_escape_string(key, NULL, TRUE);
+        g_key_file_set_string(k, group, "RelPath", e->relpath);
+        g_key_file_set_integer(k, group, "Priority", e->priority);
+        obt_link_save(e->link, k, group);
+        g_free(group);
+    }
+
+    dir = g_path_get_dirname(lb->cache_path);
+    obt_paths_mkdir_path(dir, 0700);
+    g_free(dir);
+
+    data = g_key_file_to_data(k, &len, NULL);
+    if (!g_file_set_contents(lb->cache_path, data, len, NULL))
+        g_warning("Unable to save the application cache to %s",
+                  lb->cache_path);
+    g_free(data);
+    g_key_file_free(k);
+}
+
+static gboolean save_timeout(gpointer data)
+{
+    ObtLinkBase *lb = data;
+
+    save(lb, NULL);
+    lb->save_id = 0;
+    return FALSE; /* don't repeat */
+}
+
+/*! Finds the .desktop file for the id of @relpath again, after it changed in
+  the directory with the given priority */
+static void update(ObtLinkBase *lb, gint priority, const gchar *relpath)
+{
+    ObtLinkBaseEntry *e;
+    ObtLink *link;
+    GSList *it;
+    gchar *id;
+    gint i;
+
+    id = make_id(relpath);
+    e = g_hash_table_lookup(lb->links, id);
+    if (e && e->priority < priority) {
+        /* hidden by a file in a higher priority directory */
+        g_free(id);
+        return;
+    }
+
+    /* this directory or a lower priority one might have the file now */
+    link = NULL;
+    it = g_slist_nth(lb->dirs, priority);
+    for (i = priority; it && !link; ++i, it = g_slist_next(it)) {
+        GSList one = { it->data, NULL };
+
+        link = obt_link_from_ddfile(relpath, &one, lb->paths);
+    }
+
+    if (link)
+        set_entry(lb, g_strdup(id), link, i - 1, relpath);
+    else if (e) {
+        category_remove(lb, e->link);
+        g_hash_table_remove(lb->links, id);
+    }
+
+    if (!lb->save_id)
+        lb->save_id = g_timeout_add_seconds(SAVE_DELAY, save_timeout, lb);
+    if (lb->update_func)
+        lb->update_func(lb, id, lb->update_data);
+    g_free(id);
+}
+
+/*! Updates all the files which came from below @prefix in the directory with
+  the given priority, after it was removed */
+static void update_prefix(ObtLinkBase *lb, gint priority,
+                          const gchar *prefix)
+{
+    GHashTableIter iter;
+    gpointer val;
+    GSList *relpaths, *it;
+    gsize len;
+
+    len = strlen(prefix);
+    relpaths = NULL;
+    g_hash_table_iter_init(&iter, lb->links);
+    while (g_hash_table_iter_next(&iter, NULL, &val)) {
+        ObtLinkBaseEntry *e = val;
+
+        if (e->priority == priority &&
+            (len == 0 || (!strncmp(e->relpath, prefix, len) &&
+                          e->relpath[len] == G_DIR_SEPARATOR)))
+            relpaths = g_slist_prepend(relpaths, g_strdup(e->relpath));
+    }
+
+    for (it = relpaths; it; it = g_slist_next(it)) {
+        update(lb, priority, it->data);
+        g_free(it->data);
+    }
+    g_slist_free(relpaths);
+}
+
+/*! Looks through the directory with the given priority again, after
+  changes to it were missed */
+static void rescan(ObtLinkBase *lb, gint priority, const gchar *dir)
+{
+    GSList *files, *it;
+    guint stamp;
+
+    /* the files that it had may have changed or gone away */
+    update_prefix(lb, priority, "");
+
+    /* and there may be new ones */
+    files = NULL;
+    stamp = 0;
+    scan_dir(dir, "", &files, &stamp);
+    for (it = files; it; it = g_slist_next(it)) {
+        ObtLinkBaseEntry *e;
+        gchar *id;
+
+        id = make_id(it->data);
+        e = g_hash_table_lookup(lb->links, id);
+        if (!e || e->priority > priority)
+            update(lb, priority, it->data);
+        g_free(id);
+        g_free(it->data);
+    }
+    g_slist_free(files);
+}
+
+static void dir_changed(ObtWatch *w, const gchar *base_path,
+                        const gchar *subpath, ObtWatchNotifyType type,
+                        gpointer data)
+{
+    ObtLinkBase *lb = data;
+    GSList *it;
+    gint i;
+
+    for (i = 0, it = lb->dirs; it; ++i, it = g_slist_next(it))
+        if (!strcmp(it->data, base_path)) break;
+    if (!it) return;
+
+    if (type == OBT_WATCH_LOST)
+        rescan(lb, i, it->data);
+    else if (type == OBT_WATCH_SELF_REMOVED)
+        update_prefix(lb, i, "");
+    else if (g_str_has_suffix(subpath, ".desktop"))
+        update(lb, i, subpath);
+    else if (type == OBT_WATCH_REMOVED)
+        /* a directory was removed, along with the files inside it */
+        update_prefix(lb, i, subpath);
+}
+
+ObtLinkBase* obt_linkbase_new(ObtPaths *paths, const gchar *locale)
+{
+    ObtLinkBase *lb;
+    GSList *it, **files;
+    guint *stamps;
+    gint i, n;
+
+    lb = g_slice_new(ObtLinkBase);
+    lb->ref = 1;
+    lb->paths = paths;
+    obt_paths_ref(paths);
+    lb->locale = g_strdup(locale);
+    lb->cache_path = g_build_filename(obt_paths_cache_home(paths), "openbox",
+                                      "links.cache", NULL);
+    lb->links = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                      (GDestroyNotify)entry_free);
+    lb->categories = g_hash_table_new(g_direct_hash, g_direct_equal);
+    lb->save_id = 0;
+    lb->update_func = NULL;
+    lb->update_data = NULL;
+
+    lb->dirs = NULL;
+    for (it = obt_paths_data_dirs(paths); it; it = g_slist_next(it))
+        lb->dirs = g_slist_append(lb->dirs,
+                                  g_build_filename(it->data, "applications",
+                                                   NULL));
+    n = g_slist_length(lb->dirs);
+
+    /* start watching before looking at the files, so no changes are missed
+       in between.  directories which don't exist yet are watched for when
+       they are created */
+    lb->watch = obt_watch_new();
+    for (it = lb->dirs; it; it = g_slist_next(it))
+        obt_watch_add(lb->watch, it->data, FALSE, dir_changed, lb);
+
+    files = g_new0(GSList*, n);
+    stamps = g_new0(guint, n);
+    for (i = 0, it = lb->dirs; it; ++i, it = g_slist_next(it))
+        scan_dir(it->data, "", &files[i], &stamps[i]);
+
+    if (!load(lb, stamps, n)) {
+        g_hash_table_remove_all(lb->links);
+        g_hash_table_foreach(lb->categories, category_free, NULL);
+        g_hash_table_remove_all(lb->categories);
+
+        build(lb, files);
+        save(lb, stamps);
+    }
+
+    for (i = 0; i < n; ++i) {
+        g_slist_foreach(files[i], (GFunc)g_free, NULL);
+        g_slist_free(files[i]);
+    }
+    g_free(files);
+    g_free(stamps);
+
+    return lb;
+}
+
+void obt_linkbase_ref(ObtLinkBase *lb)
+{
+    ++lb->ref;
+}
+
+void obt_linkbase_unref(ObtLinkBase *lb)
+{
+    if (lb && --lb->ref < 1) {
+        if (lb->save_id) {
+            g_source_remove(lb->save_id);
+            save(lb, NULL);
+        }
+        obt_watch_unref(lb->watch);
+
+        g_hash_table_foreach(lb->categories, category_free, NULL);
+        g_hash_table_destroy(lb->categories);
+        g_hash_table_destroy(lb->links);
+
+        g_slist_foreach(lb->dirs, (GFunc)g_free, NULL);
+        g_slist_free(lb->dirs);
+        g_free(lb->cache_path);
+        g_free(lb->locale);
+        obt_paths_unref(lb->paths);
+        g_slice_free(ObtLinkBase, lb);
+    }
+}
+
+void obt_linkbase_set_update_func(ObtLinkBase *lb, ObtLinkBaseUpdateFunc func,
+                                  gpointer data)
+{
+    lb->update_func = func;
+    lb->update_data = data;
+}
+
+ObtLink* obt_linkbase_find(ObtLinkBase *lb, const gchar *id)
+{
+    ObtLinkBaseEntry *e;
+
+    e = g_hash_table_lookup(lb->links, id);
+    if (e && !obt_link_deleted(e->link))
+        return e->link;
+    return NULL;
+}
+
+GSList* obt_linkbase_category(ObtLinkBase *lb, GQuark category)
+{
+    return g_hash_table_lookup(lb->categories, GUINT_TO_POINTER(category));
+}
@@ -0,0 +1,67 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   obt/linkbase.h for the Openbox window manager
+   Copyright (c) 2026        The Openbox developers
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#ifndef __obt_linkbase_h
+#define __obt_linkbase_h
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+struct _ObtLink;
+struct _ObtPaths;
+
+/*! An index of all the applications' .desktop files found in the XDG data
+  directories.  The index is saved in the user's cache directory so that it
+  only has to be rebuilt when the .desktop files change, and it is kept up to
+  date while it is in use, where watching files is supported. */
+typedef struct _ObtLinkBase ObtLinkBase;
+
+/*! Called after a .desktop file in the ObtLinkBase was added, removed or
+  changed.
+  @param id The desktop file id of the changed ObtLink.
+*/
+typedef void (*ObtLinkBaseUpdateFunc)(ObtLinkBase *lb, const gchar *id,
+                                      gpointer data);
+
+/*! Create a new database of ObtLinks.
+  @param paths An ObtPaths structure, which contains the XDG data directories
+               to look in.
+  @param locale The locale used for the names and comments in the ObtLinks.
+*/
+ObtLinkBase* obt_linkbase_new(struct _ObtPaths *paths, const gchar *locale);
+void obt_linkbase_ref(ObtLinkBase *lb);
+void obt_linkbase_unref(ObtLinkBase *lb);
+
+/*! Sets a function to be called when the ObtLinkBase changes, or NULL */
+void obt_linkbase_set_update_func(ObtLinkBase *lb, ObtLinkBaseUpdateFunc func,
+                                  gpointer data);
+
+/*! Returns the ObtLink for a desktop file id, such as "kde4-konsole.desktop",
+  or NULL if there is none.  Deleted (Hidden) .desktop files are not
+  returned. */
+struct _ObtLink* obt_linkbase_find(ObtLinkBase *lb, const gchar *id);
+
+/*! Returns a list of the ObtLinks for the applications in a category.  The
+  list is owned by the ObtLinkBase, and is only valid until the next time
+  that the main loop runs. */
+GSList* obt_linkbase_category(ObtLinkBase *lb, GQuark category);
+
+G_END_DECLS
+
+#endif
@@ -0,0 +1,184 @@
+#include "obt/unittest_base.h"
+
+#include "obt/linkbase.h"
+#include "obt/paths.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* A fake XDG environment, with a user data directory, which has the higher
+   priority, and a system one */
+static gchar *root = NULL;
+static gchar *user_apps = NULL;
+static gchar *system_apps = NULL;
+
+static gboolean waiting = FALSE;
+
+static const gchar *app = "[Desktop Entry]\n"
+                          "Type=Application\n"
+                          "Name=Test\n"
+                          "Exec=test\n";
+static const gchar *hidden = "[Desktop Entry]\n"
+                             "Type=Application\n"
+                             "Name=Test\n"
+                             "Exec=test\n"
+                             "Hidden=true\n";
+
+static void write_file(const gchar *dir, const gchar *name,
+                       const gchar *contents) {
+    gchar *f = g_build_filename(dir, name, NULL);
+    g_assert(g_file_set_contents(f, contents, -1, NULL));
+    g_free(f);
+}
+
+static void remove_file(const gchar *dir, const gchar *name) {
+    gchar *f = g_build_filename(dir, name, NULL);
+    g_unlink(f);
+    g_free(f);
+}
+
+static void remove_tree(const gchar *path) {
+    GDir *d;
+    const gchar *name;
+
+    if ((d = g_dir_open(path, 0, NULL))) {
+        while ((name = g_dir_read_name(d))) {
+            gchar *f = g_build_filename(path, name, NULL);
+            remove_tree(f);
+            g_free(f);
+        }
+        g_dir_close(d);
+        g_rmdir(path);
+    }
+    else
+        g_unlink(path);
+}
+
+static void set_dir_env(const gchar *var, const gchar *name) {
+    gchar *dir = g_build_filename(root, name, NULL);
+    g_assert(g_mkdir_with_parents(dir, 0700) == 0);
+    g_setenv(var, dir, TRUE);
+    g_free(dir);
+}
+
+static void setup() {
+    root = g_build_filename(g_get_tmp_dir(), "obt-linkbase-XXXXXX", NULL);
+    g_assert(mkdtemp(root));
+
+    set_dir_env("XDG_CONFIG_HOME", "config");
+    set_dir_env("XDG_CONFIG_DIRS", "etc");
+    set_dir_env("XDG_CACHE_HOME", "cache");
+    set_dir_env("XDG_DATA_HOME", "user");
+    set_dir_env("XDG_DATA_DIRS", "system");
+
+    user_apps = g_build_filename(root, "user", "applications", NULL);
+    system_apps = g_build_filename(root, "system", "applications", NULL);
+    g_assert(g_mkdir_with_parents(user_apps, 0700) == 0);
+    g_assert(g_mkdir_with_parents(system_apps, 0700) == 0);
+}
+
+static void teardown() {
+    remove_tree(root);
+    g_free(root);
+    g_free(user_apps);
+    g_free(system_apps);
+    root = user_apps = system_apps = NULL;
+}
+
+static void updated(ObtLinkBase *lb, const gchar *id, gpointer data) {
+    if (!strcmp(id, data))
+        waiting = FALSE;
+}
+
+static gboolean wait_timeout(gpointer data) {
+    waiting = FALSE;
+    return FALSE; /* don't repeat */
+}
+
+/* Runs the main loop until the ObtLinkBase reports a change to @id, or gives
+   up after a few seconds */
+static void wait_for_update(ObtLinkBase *lb, const gchar *id) {
+    guint timeout;
+
+    obt_linkbase_set_update_func(lb, updated, (gpointer)id);
+    timeout = g_timeout_add(5000, wait_timeout, NULL);
+    waiting = TRUE;
+    while (waiting)
+        g_main_context_iteration(NULL, TRUE);
+    g_source_remove(timeout);
+    obt_linkbase_set_update_func(lb, NULL, NULL);
+}
+
+static void hidden_masks_system() {
+    TEST_START();
+
+    ObtPaths *paths;
+    ObtLinkBase *lb;
+
+    write_file(system_apps, "shown.desktop", app);
+    write_file(system_apps, "masked.desktop", app);
+    write_file(user_apps, "masked.desktop", hidden);
+
+    paths = obt_paths_new();
+
+    /* built from the .desktop files */
+    lb = obt_linkbase_new(paths, "C");
+    EXPECT_BOOL_EQ(TRUE, obt_linkbase_find(lb, "shown.desktop") != NULL);
+    EXPECT_BOOL_EQ(TRUE, obt_linkbase_find(lb, "masked.desktop") == NULL);
+    obt_linkbase_unref(lb);
+
+    /* loaded from the cache that was saved */
+    lb = obt_linkbase_new(paths, "C");
+    EXPECT_BOOL_EQ(TRUE, obt_linkbase_find(lb, "shown.desktop") != NULL);
+    EXPECT_BOOL_EQ(TRUE, obt_linkbase_find(lb, "masked.desktop") == NULL);
+    obt_linkbase_unref(lb);
+
+    obt_paths_unref(paths);
+
+    remove_file(system_apps, "shown.desktop");
+    remove_file(system_apps, "masked.desktop");
+    remove_file(user_apps, "masked.desktop");
+
+    TEST_END();
+}
+
+static void hidden_while_running() {
+    TEST_START();
+
+    ObtPaths *paths;
+    ObtLinkBase *lb;
+
+    write_file(system_apps, "live.desktop", app);
+
+    paths = obt_paths_new();
+    lb = obt_linkbase_new(paths, "C");
+    EXPECT_BOOL_EQ(TRUE, obt_linkbase_find(lb, "live.desktop") != NULL);
+
+    /* hiding it in the user's directory removes it */
+    write_file(user_apps, "live.desktop", hidden);
+    wait_for_update(lb, "live.desktop");
+    EXPECT_BOOL_EQ(TRUE, obt_linkbase_find(lb, "live.desktop") == NULL);
+
+    /* removing the mask uncovers the system file again */
+    remove_file(user_apps, "live.desktop");
+    wait_for_update(lb, "live.desktop");
+    EXPECT_BOOL_EQ(TRUE, obt_linkbase_find(lb, "live.desktop") != NULL);
+
+    obt_linkbase_unref(lb);
+    obt_paths_unref(paths);
+
+    remove_file(system_apps, "live.desktop");
+
+    TEST_END();
+}
+
+void run_linkbase_unittest() {
+    unittest_start_suite("linkbase");
+    setup();
+    hidden_masks_system();
+    hidden_while_running();
+    teardown();
+    unittest_end_suite();
+}
@@ -41,6 +41,28 @@
 #ifdef HAVE_PWD_H
 #  include <pwd.h>
 #endif
+#include <time.h>
+
+/*! How often to check the directories in $PATH for changes, in
+  microseconds */
+#define EXEC_CHECK_INTERVAL G_USEC_PER_SEC
+
+/*! Whether a file in a directory in $PATH can be executed.  These are not 0
+  so that they can be told apart from a missing file in the hash table. */
+typedef enum {
+    EXEC_UNKNOWN = 1, /*!< The file hasn't been looked at yet */
+    EXEC_YES,
+    EXEC_NO
+} ObtPathsExecState;
+
+/*! A snapshot of the files in one of the directories in $PATH */
+typedef struct _ObtPathsExecDir {
+    gchar *path;
+    time_t mtime; /*!< The directory's mtime when the files were listed, or
+                    -1 to list them again at the next check */
+    GHashTable *names; /*!< Maps each file's name to its ObtPathsExecState,
+                         or NULL if the directory could not be read */
+} ObtPathsExecDir;
 
 struct _ObtPaths
 {
@@ -51,7 +73,9 @@ struct _ObtPaths
     GSList *config_dirs;
     GSList *data_dirs;
     GSList *autostart_dirs;
-    GSList *exec_dirs;
+    GSList *exec_dirs; /*!< List of ObtPathsExecDir for each dir in $PATH */
+    gint64  exec_checked; /*!< When the exec_dirs were last checked for
+                            changes */
 
     uid_t   uid;
     gid_t  *gid;
@@ -210,6 +234,14 @@ ObtPaths* obt_paths_new(void)
         p->exec_dirs = split_paths(path);
     else
         p->exec_dirs = NULL;
+    for (it = p->exec_dirs; it; it = g_slist_next(it)) {
+        ObtPathsExecDir *d = g_slice_new(ObtPathsExecDir);
+        d->path = it->data;
+        d->mtime = -1;
+        d->names = NULL;
+        it->data = d;
+    }
+    p->exec_checked = -EXEC_CHECK_INTERVAL;
 
     return p;
 }
@@ -233,8 +265,12 @@ void obt_paths_unref(ObtPaths *p)
         for (it = p->autostart_dirs; it; it = g_slist_next(it))
             g_free(it->data);
         g_slist_free(p->autostart_dirs);
-        for (it = p->exec_dirs; it; it = g_slist_next(it))
-            g_free(it->data);
+        for (it = p->exec_dirs; it; it = g_slist_next(it)) {
+            ObtPathsExecDir *d = it->data;
+            if (d->names) g_hash_table_destroy(d->names);
+            g_free(d->path);
+            g_slice_free(ObtPathsExecDir, d);
+        }
         g_slist_free(p->exec_dirs);
         g_free(p->config_home);
         g_free(p->data_home);
@@ -343,11 +379,78 @@ static inline gboolean try_exec(const ObtPaths *const p,
     if (!S_ISREG(st.st_mode))
         return FALSE;
     if (st.st_uid == p->uid)
-        return st.st_mode & S_IXUSR;
+        return (st.st_mode & S_IXUSR) != 0;
     BSEARCH(guint, p->gid, 0, p->n_gid, st.st_gid);
     if (BSEARCH_FOUND())
-        return st.st_mode & S_IXGRP;
-    return st.st_mode & S_IXOTH;
+        return (st.st_mode & S_IXGRP) != 0;
+    return (st.st_mode & S_IXOTH) != 0;
+}
+
+/*! Lists the files in a directory again if it has changed since it was last
+  listed */
+static void exec_dir_update(ObtPathsExecDir *d, time_t now)
+{
+    struct stat st;
+    GDir *dir;
+    const gchar *name;
+
+    if (stat(d->path, &st) != 0) {
+        if (d->names) g_hash_table_destroy(d->names);
+        d->names = NULL;
+        d->mtime = -1;
+        return;
+    }
+    if (d->names && st.st_mtime == d->mtime)
+        return; /* nothing was added or removed */
+
+    if (d->names) g_hash_table_destroy(d->names);
+    d->names = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    if ((dir = g_dir_open(d->path, 0, NULL))) {
+        while ((name = g_dir_read_name(dir)))
+            g_hash_table_insert(d->names, g_strdup(name),
+                                GUINT_TO_POINTER(EXEC_UNKNOWN));
+        g_dir_close(dir);
+    }
+
+    /* another change within the same second would not change the mtime, so
+       don't trust this listing past the next check */
+    d->mtime = st.st_mtime >= now ? -1 : st.st_mtime;
+}
+
+/*! Looks for a file name in the snapshots of the directories in $PATH.  The
+  directories are only looked at again if they have changed, and each file is
+  only stat()ed the first time it is looked for. */
+static gboolean try_exec_cached(ObtPaths *p, const gchar *name)
+{
+    GSList *it;
+    gint64 now;
+
+    now = g_get_monotonic_time();
+    if (now - p->exec_checked >= EXEC_CHECK_INTERVAL) {
+        const time_t t = time(NULL);
+
+        for (it = p->exec_dirs; it; it = g_slist_next(it))
+            exec_dir_update(it->data, t);
+        p->exec_checked = now;
+    }
+
+    for (it = p->exec_dirs; it; it = g_slist_next(it)) {
+        ObtPathsExecDir *d = it->data;
+        ObtPathsExecState state;
+
+        if (!d->names) continue;
+
+        state = GPOINTER_TO_UINT(g_hash_table_lookup(d->names, name));
+        if (state == EXEC_UNKNOWN) {
+            gchar *f = g_build_filename(d->path, name, NULL);
+            state = try_exec(p, f) ? EXEC_YES : EXEC_NO;
+            g_free(f);
+            g_hash_table_insert(d->names, g_strdup(name),
+                                GUINT_TO_POINTER(state));
+        }
+        if (state == EXEC_YES) return TRUE;
+    }
+    return FALSE;
 }
 
 gboolean obt_paths_try_exec(ObtPaths *p, const gchar *path)
@@ -355,11 +458,15 @@ gboolean obt_paths_try_exec(ObtPaths *p, const gchar *path)
     if (path[0] == '/') {
         return try_exec(p, path);
     }
+    else if (!strchr(path, '/')) {
+        return try_exec_cached(p, path);
+    }
     else {
         GSList *it;
 
         for (it = p->exec_dirs; it; it = g_slist_next(it)) {
-            gchar *f = g_build_filename(it->data, path, NULL);
+            ObtPathsExecDir *d = it->data;
+            gchar *f = g_build_filename(d->path, path, NULL);
             gboolean e = try_exec(p, f);
             g_free(f);
             if (e) return TRUE;
@@ -42,6 +42,9 @@ gboolean obt_paths_mkdir_path(const gchar *path, gint mode);
 
 /*! Returns TRUE if the @path points to an executable file.
   If the @path is not an absolute path, then it is searched for in $PATH.
+  The contents of the directories in $PATH are remembered, and only read
+  again when they change, so a file which has its permissions changed may
+  not be noticed.
 */
 gboolean obt_paths_try_exec(ObtPaths *p, const gchar *path);
 
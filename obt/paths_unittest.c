@@ -0,0 +1,133 @@
+#include "obt/unittest_base.h"
+
+#include "obt/paths.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <utime.h>
+
+/* The only directory in $PATH */
+static gchar *bin = NULL;
+
+static void setup() {
+    bin = g_build_filename(g_get_tmp_dir(), "obt-paths-XXXXXX", NULL);
+    g_assert(mkdtemp(bin));
+    g_setenv("PATH", bin, TRUE);
+}
+
+static void teardown() {
+    GDir *d;
+    const gchar *name;
+
+    d = g_dir_open(bin, 0, NULL);
+    g_assert(d);
+    while ((name = g_dir_read_name(d))) {
+        gchar *f = g_build_filename(bin, name, NULL);
+        g_unlink(f);
+        g_free(f);
+    }
+    g_dir_close(d);
+    g_rmdir(bin);
+    g_free(bin);
+    bin = NULL;
+}
+
+static void add_program(const gchar *name) {
+    gchar *f = g_build_filename(bin, name, NULL);
+    g_assert(g_file_set_contents(f, "#!/bin/sh\n", -1, NULL));
+    g_assert(g_chmod(f, 0755) == 0);
+    g_free(f);
+}
+
+/* Sets the directory's mtime, so it does not show a change */
+static void set_mtime(time_t t) {
+    struct utimbuf u;
+
+    u.actime = u.modtime = t;
+    g_assert(utime(bin, &u) == 0);
+}
+
+/* Waits long enough for the directories in $PATH to be looked at again */
+static void wait_for_check() {
+    g_usleep(G_USEC_PER_SEC + G_USEC_PER_SEC / 10);
+}
+
+static void added_program() {
+    TEST_START();
+
+    ObtPaths *p;
+
+    set_mtime(time(NULL) - 10);
+
+    p = obt_paths_new();
+    EXPECT_BOOL_EQ(FALSE, obt_paths_try_exec(p, "obt-test-added"));
+
+    /* the directory's mtime changes */
+    add_program("obt-test-added");
+    wait_for_check();
+    EXPECT_BOOL_EQ(TRUE, obt_paths_try_exec(p, "obt-test-added"));
+    EXPECT_BOOL_EQ(FALSE, obt_paths_try_exec(p, "obt-test-missing"));
+
+    obt_paths_unref(p);
+
+    TEST_END();
+}
+
+static void same_second_change() {
+    TEST_START();
+
+    ObtPaths *p;
+    time_t t;
+
+    /* give the directory an mtime which is not in the past, as it would
+       have if it was changed in the same second that it was listed */
+    t = time(NULL) + 10;
+    set_mtime(t);
+
+    p = obt_paths_new();
+    EXPECT_BOOL_EQ(FALSE, obt_paths_try_exec(p, "obt-test-same"));
+
+    /* change it without the mtime moving on */
+    add_program("obt-test-same");
+    set_mtime(t);
+
+    /* the listing that was made is not trusted */
+    wait_for_check();
+    EXPECT_BOOL_EQ(TRUE, obt_paths_try_exec(p, "obt-test-same"));
+
+    obt_paths_unref(p);
+
+    TEST_END();
+}
+
+static void full_paths() {
+    TEST_START();
+
+    ObtPaths *p;
+    gchar *f;
+
+    add_program("obt-test-full");
+    f = g_build_filename(bin, "obt-test-full", NULL);
+
+    /* absolute paths are not looked for in $PATH */
+    p = obt_paths_new();
+    EXPECT_BOOL_EQ(TRUE, obt_paths_try_exec(p, f));
+    EXPECT_BOOL_EQ(FALSE, obt_paths_try_exec(p, "/obt-test-full"));
+    obt_paths_unref(p);
+
+    g_free(f);
+
+    TEST_END();
+}
+
+void run_paths_unittest() {
+    unittest_start_suite("paths");
+    setup();
+    added_program();
+    same_second_change();
+    full_paths();
+    teardown();
+    unittest_end_suite();
+}
@@ -84,6 +84,10 @@ static GSourceFuncs source_funcs = {
 static GSource *gsource = NULL;
 static guint listeners = 0; /* a ref count for the signal listener */
 static gboolean signal_fired;
+/* a fixed array, so the signal handler doesn't walk through memory which is
+   being changed */
+#define NUM_CRASH_HANDLERS 4
+static ObtSignalCallback crash_handlers[NUM_CRASH_HANDLERS];
 guint signals_fired[NUM_SIGNALS];
 GSList *callbacks[NUM_SIGNALS];
 
@@ -263,6 +267,33 @@ static gboolean signal_occurred(GSource *source, GSourceFunc callback,
     return TRUE; /* repeat */
 }
 
+void obt_signal_add_crash_handler(ObtSignalHandler func, gpointer data)
+{
+    gint i;
+
+    g_return_if_fail(func != NULL);
+
+    for (i = 0; i < NUM_CRASH_HANDLERS; ++i)
+        if (!crash_handlers[i].func) {
+            crash_handlers[i].data = data;
+            crash_handlers[i].func = func;
+            return;
+        }
+    g_warning("Too many crash handlers");
+}
+
+void obt_signal_remove_crash_handler(ObtSignalHandler func)
+{
+    gint i;
+
+    for (i = 0; i < NUM_CRASH_HANDLERS; ++i)
+        if (crash_handlers[i].func == func) {
+            crash_handlers[i].func = NULL;
+            crash_handlers[i].data = NULL;
+            break;
+        }
+}
+
 static void sighandler(gint sig)
 {
     guint i;
@@ -277,6 +308,10 @@ static void sighandler(gint sig)
             fprintf(stderr, "How are you gentlemen? All your base are"
                     " belong to us. (Openbox received signal %d)\n", sig);
 
+            for (i = 0; i < NUM_CRASH_HANDLERS; ++i)
+                if (crash_handlers[i].func)
+                    crash_handlers[i].func(sig, crash_handlers[i].data);
+
             /* die with a core dump */
             abort();
         }
@@ -41,6 +41,16 @@ void obt_signal_add_callback(gint sig, ObtSignalHandler func, gpointer data);
 /*! Removes the most recently added callback with the given function. */
 void obt_signal_remove_callback(gint sig, ObtSignalHandler func);
 
+/*! Adds a function to be called when a signal which causes the core to dump
+  is received, right before dumping it.  It is called from inside the signal
+  handler, so it must only use functions which are safe there, such as
+  write().  Only a few crash handlers can be added at a time.
+*/
+void obt_signal_add_crash_handler(ObtSignalHandler func, gpointer data);
+
+/*! Removes a crash handler added with obt_signal_add_crash_handler(). */
+void obt_signal_remove_crash_handler(ObtSignalHandler func);
+
 G_END_DECLS
 
 #endif
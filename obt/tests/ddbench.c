@@ -0,0 +1,101 @@
+#/*
+#!/bin/sh
+#*/
+#if 0
+gcc -O2 -I../.. -o ./ddbench `pkg-config --cflags --libs obt-3.5` ddbench.c && \
+./ddbench "$@"
+exit
+#endif
+
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   ddbench.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox developers
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+/* Measures how fast .desktop files are parsed.  Every .desktop file in the
+   directory is parsed the given number of times (10 by default).
+
+   usage: ddbench DIRECTORY [ROUNDS]
+*/
+
+#include "obt/ddparse.h"
+#include <glib.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+gint main(int argc, char **argv)
+{
+    GDir *dir;
+    GSList *paths, *names, *it;
+    const gchar *name;
+    GTimer *timer;
+    gulong files, parsed, bytes;
+    gint rounds, i;
+    gdouble secs;
+
+    if (argc < 2) {
+        g_print("usage: %s DIRECTORY [ROUNDS]\n", argv[0]);
+        return 1;
+    }
+    rounds = argc > 2 ? atoi(argv[2]) : 10;
+
+    if (!(dir = g_dir_open(argv[1], 0, NULL))) {
+        g_print("unable to open %s\n", argv[1]);
+        return 1;
+    }
+    names = NULL;
+    files = bytes = 0;
+    while ((name = g_dir_read_name(dir))) {
+        gchar *path;
+        struct stat st;
+
+        if (!g_str_has_suffix(name, ".desktop")) continue;
+
+        path = g_build_filename(argv[1], name, NULL);
+        if (stat(path, &st) == 0) {
+            names = g_slist_prepend(names, g_strdup(name));
+            ++files;
+            bytes += st.st_size;
+        }
+        g_free(path);
+    }
+    g_dir_close(dir);
+
+    paths = g_slist_prepend(NULL, argv[1]);
+    parsed = 0;
+    timer = g_timer_new();
+    for (i = 0; i < rounds; ++i)
+        for (it = names; it; it = g_slist_next(it)) {
+            ObtDDParseGroup *g = obt_ddparse_file(it->data, paths);
+            if (g) {
+                ++parsed;
+                obt_ddparse_group_free(g);
+            }
+        }
+    secs = g_timer_elapsed(timer, NULL);
+    g_timer_destroy(timer);
+
+    g_print("%lu files (%lu bytes), %lu parsed in %d rounds\n",
+            files, bytes, parsed / MAX(rounds, 1), rounds);
+    if (secs > 0)
+        g_print("%.3f s, %.0f files/s, %.2f MB/s\n", secs,
+                files * rounds / secs, bytes * rounds / secs / 1e6);
+
+    g_slist_foreach(names, (GFunc)g_free, NULL);
+    g_slist_free(names);
+    g_slist_free(paths);
+    return 0;
+}
@@ -0,0 +1,125 @@
+#/*
+#!/bin/sh
+#*/
+#if 0
+gcc -O2 -I../.. -o ./pathbench `pkg-config --cflags --libs obt-3.5` \
+pathbench.c && \
+./pathbench "$@"
+exit
+#endif
+
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   pathbench.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox developers
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+/* Measures how fast programs are looked for in $PATH, as is done for
+   TryExec in .desktop files.  The lookups (2000 by default) are split between
+   programs that exist, found in the last directory in $PATH, and programs
+   that don't exist.  Searching with stat() for every directory is timed for
+   comparison.
+
+   usage: pathbench [LOOKUPS]
+*/
+
+#include "obt/paths.h"
+#include <glib.h>
+#include <stdlib.h>
+
+/* look through each directory in $PATH, without any caching */
+static gboolean search(gchar **dirs, const gchar *name)
+{
+    gchar **d;
+
+    for (d = dirs; *d; ++d) {
+        gchar *f = g_build_filename(*d, name, NULL);
+        gboolean e = g_file_test(f, G_FILE_TEST_IS_EXECUTABLE) &&
+            !g_file_test(f, G_FILE_TEST_IS_DIR);
+        g_free(f);
+        if (e) return TRUE;
+    }
+    return FALSE;
+}
+
+gint main(int argc, char **argv)
+{
+    ObtPaths *paths;
+    GPtrArray *names;
+    GDir *dir;
+    const gchar *name;
+    gchar **dirs;
+    GTimer *timer;
+    gint lookups, i, n, found;
+    gdouble secs;
+
+    lookups = argc > 1 ? atoi(argv[1]) : 2000;
+    if (lookups < 1) {
+        g_print("usage: %s [LOOKUPS]\n", argv[0]);
+        return 1;
+    }
+
+    dirs = g_strsplit(g_getenv("PATH") ? g_getenv("PATH") : "", ":", -1);
+    n = g_strv_length(dirs);
+    if (n == 0) {
+        g_print("$PATH is empty\n");
+        return 1;
+    }
+
+    /* programs from the last directory have to be looked for in all of
+       them */
+    names = g_ptr_array_new();
+    if ((dir = g_dir_open(dirs[n-1], 0, NULL))) {
+        while ((name = g_dir_read_name(dir)) &&
+               (gint)names->len < lookups / 2)
+            g_ptr_array_add(names, g_strdup(name));
+        g_dir_close(dir);
+    }
+    for (i = 0; (gint)names->len < lookups; ++i)
+        g_ptr_array_add(names, g_strdup_printf("not-a-program-%d", i));
+
+    timer = g_timer_new();
+
+    g_timer_start(timer);
+    for (i = found = 0; i < lookups; ++i)
+        found += search(dirs, names->pdata[i]);
+    secs = g_timer_elapsed(timer, NULL);
+    g_print("stat:   %d lookups (%d found) in %.3f ms\n",
+            lookups, found, secs * 1000);
+
+    paths = obt_paths_new();
+
+    g_timer_start(timer);
+    for (i = found = 0; i < lookups; ++i)
+        found += obt_paths_try_exec(paths, names->pdata[i]);
+    secs = g_timer_elapsed(timer, NULL);
+    g_print("cold:   %d lookups (%d found) in %.3f ms\n",
+            lookups, found, secs * 1000);
+
+    g_timer_start(timer);
+    for (i = found = 0; i < lookups; ++i)
+        found += obt_paths_try_exec(paths, names->pdata[i]);
+    secs = g_timer_elapsed(timer, NULL);
+    g_print("cached: %d lookups (%d found) in %.3f ms\n",
+            lookups, found, secs * 1000);
+
+    obt_paths_unref(paths);
+    g_timer_destroy(timer);
+    for (i = 0; i < (gint)names->len; ++i)
+        g_free(names->pdata[i]);
+    g_ptr_array_free(names, TRUE);
+    g_strfreev(dirs);
+    return 0;
+}
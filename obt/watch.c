@@ -0,0 +1,528 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   obt/watch.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox developers
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#include "obt/watch.h"
+
+#ifdef HAVE_SYS_INOTIFY_H
+#  include <sys/inotify.h>
+#endif
+#ifdef HAVE_STRING_H
+#  include <string.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#  include <sys/stat.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#  include <fcntl.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+#endif
+#ifdef HAVE_ERRNO_H
+#  include <errno.h>
+#endif
+
+typedef struct _ObtWatchTarget ObtWatchTarget;
+typedef struct _ObtWatchFile ObtWatchFile;
+
+struct _ObtWatch {
+    guint ref;
+    gint fd; /*!< The inotify descriptor, or -1 */
+    guint source; /*!< The main loop source watching the descriptor */
+    GHashTable *targets; /*!< Maps a path given to obt_watch_add() to its
+                           ObtWatchTarget */
+    GHashTable *wds; /*!< Maps an inotify watch descriptor to the
+                       ObtWatchFile it watches */
+    GHashTable *waits; /*!< Maps an inotify watch descriptor to a GSList of
+                         the ObtWatchTargets waiting for their path to be
+                         created inside that directory */
+};
+
+struct _ObtWatchTarget {
+    ObtWatch *w;
+    gchar *base_path;
+    gboolean dir_only;
+    ObtWatchFunc func;
+    gpointer data;
+    ObtWatchFile *root;
+    gint wait_wd; /*!< While base_path doesn't exist, this watches the
+                    nearest directory above it which does, or it is -1 */
+};
+
+/*! A single file or directory which has an inotify watch on it */
+struct _ObtWatchFile {
+    ObtWatchTarget *t;
+    gchar *subpath; /*!< The path relative to the target's base_path */
+    gint wd;
+    GHashTable *children; /*!< Maps a name to the ObtWatchFile for a
+                            subdirectory, or NULL for a file */
+};
+
+#ifdef HAVE_SYS_INOTIFY_H
+#define FILE_MASK (IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF)
+#define DIR_MASK (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | \
+                  IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF | \
+                  IN_ONLYDIR)
+/* added to whatever else is watched in the same directory */
+#define WAIT_MASK (IN_CREATE | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | \
+                   IN_ONLYDIR | IN_MASK_ADD)
+
+static gboolean read_events(GIOChannel *source, GIOCondition cond,
+                            gpointer data);
+static gboolean target_wait(ObtWatchTarget *t);
+#endif
+static void target_unwait(ObtWatchTarget *t);
+static void target_free(ObtWatchTarget *t);
+static void file_free(ObtWatchFile *f);
+
+ObtWatch* obt_watch_new(void)
+{
+    ObtWatch *w;
+
+    w = g_slice_new(ObtWatch);
+    w->ref = 1;
+    w->fd = -1;
+    w->source = 0;
+    w->targets = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                       NULL, (GDestroyNotify)target_free);
+    w->wds = g_hash_table_new(g_int_hash, g_int_equal);
+    w->waits = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+#ifdef HAVE_SYS_INOTIFY_H
+    w->fd = inotify_init();
+    if (w->fd >= 0) {
+        GIOChannel *ch;
+
+        fcntl(w->fd, F_SETFD, FD_CLOEXEC);
+        fcntl(w->fd, F_SETFL, O_NONBLOCK);
+
+        ch = g_io_channel_unix_new(w->fd);
+        w->source = g_io_add_watch(ch, G_IO_IN, read_events, w);
+        g_io_channel_unref(ch);
+    }
+#endif
+    return w;
+}
+
+void obt_watch_ref(ObtWatch *w)
+{
+    ++w->ref;
+}
+
+void obt_watch_unref(ObtWatch *w)
+{
+    if (w && --w->ref < 1) {
+        g_hash_table_destroy(w->targets);
+        g_hash_table_destroy(w->wds);
+        g_hash_table_destroy(w->waits);
+        if (w->source) g_source_remove(w->source);
+        if (w->fd >= 0) close(w->fd);
+        g_slice_free(ObtWatch, w);
+    }
+}
+
+static void target_free(ObtWatchTarget *t)
+{
+    target_unwait(t);
+    if (t->root) file_free(t->root);
+    g_free(t->base_path);
+    g_slice_free(ObtWatchTarget, t);
+}
+
+static void file_free(ObtWatchFile *f)
+{
+    ObtWatch *w = f->t->w;
+
+    /* the watch descriptor may already be gone if the file was removed, in
+       which case this just fails */
+#ifdef HAVE_SYS_INOTIFY_H
+    if (!g_hash_table_lookup(w->waits, GINT_TO_POINTER(f->wd)))
+        inotify_rm_watch(w->fd, f->wd);
+#endif
+    g_hash_table_remove(w->wds, &f->wd);
+
+    if (f->children) g_hash_table_destroy(f->children);
+    g_free(f->subpath);
+    g_slice_free(ObtWatchFile, f);
+}
+
+/*! Stops waiting for the target's path to be created */
+static void target_unwait(ObtWatchTarget *t)
+{
+    ObtWatch *w = t->w;
+    gpointer key;
+    GSList *list;
+
+    if (t->wait_wd < 0) return;
+
+    key = GINT_TO_POINTER(t->wait_wd);
+    list = g_slist_remove(g_hash_table_lookup(w->waits, key), t);
+    if (list)
+        g_hash_table_insert(w->waits, key, list);
+    else {
+        g_hash_table_remove(w->waits, key);
+#ifdef HAVE_SYS_INOTIFY_H
+        if (!g_hash_table_lookup(w->wds, &t->wait_wd))
+            inotify_rm_watch(w->fd, t->wait_wd);
+#endif
+    }
+    t->wait_wd = -1;
+}
+
+#ifdef HAVE_SYS_INOTIFY_H
+static gchar* child_subpath(ObtWatchFile *f, const gchar *name)
+{
+    if (f->subpath[0] == '\0')
+        return g_strdup(name);
+    return g_build_filename(f->subpath, name, NULL);
+}
+
+/*! Watches a path inside the target, and all of its subdirectories.
+  @param added If not NULL, the subpaths of everything found inside the
+               directory are appended to it.
+*/
+static ObtWatchFile* file_new(ObtWatchTarget *t, const gchar *subpath,
+                              GSList **added)
+{
+    ObtWatchFile *f;
+    gchar *path;
+    struct stat st;
+    gint wd;
+
+    path = g_build_filename(t->base_path, subpath, NULL);
+    if (stat(path, &st) < 0 ||
+        (wd = inotify_add_watch(t->w->fd, path,
+                                S_ISDIR(st.st_mode) ?
+                                DIR_MASK : FILE_MASK)) < 0)
+    {
+        g_free(path);
+        return NULL;
+    }
+
+    /* the same directory can be reached twice through links, but the kernel
+       gives it a single watch descriptor */
+    if (g_hash_table_lookup(t->w->wds, &wd)) {
+        g_free(path);
+        return NULL;
+    }
+
+    f = g_slice_new(ObtWatchFile);
+    f->t = t;
+    f->subpath = g_strdup(subpath);
+    f->wd = wd;
+    f->children = NULL;
+    g_hash_table_insert(t->w->wds, &f->wd, f);
+
+    if (S_ISDIR(st.st_mode)) {
+        GDir *dir;
+        const gchar *name;
+
+        f->children = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                            (GDestroyNotify)file_free);
+
+        if ((dir = g_dir_open(path, 0, NULL))) {
+            while ((name = g_dir_read_name(dir))) {
+                gchar *sub, *full;
+                ObtWatchFile *c;
+
+                sub = child_subpath(f, name);
+                full = g_build_filename(path, name, NULL);
+                if (g_file_test(full, G_FILE_TEST_IS_DIR) &&
+                    (c = file_new(t, sub, added)))
+                {
+                    g_hash_table_insert(f->children, g_strdup(name), c);
+                }
+                if (added && (!t->dir_only ||
+                              g_file_test(full, G_FILE_TEST_IS_DIR)))
+                    *added = g_slist_append(*added, sub);
+                else
+                    g_free(sub);
+                g_free(full);
+            }
+            g_dir_close(dir);
+        }
+    }
+
+    g_free(path);
+    return f;
+}
+
+/*! Reports a list of changes, stopping if the callback stops watching the
+  target */
+static void notify(ObtWatch *w, ObtWatchTarget *t, GSList *subpaths,
+                   ObtWatchNotifyType type)
+{
+    gchar *base;
+    GSList *it;
+
+    base = g_strdup(t->base_path);
+    for (it = subpaths; it; it = g_slist_next(it)) {
+        if (g_hash_table_lookup(w->targets, base) != t) break;
+        t->func(w, base, it->data, type, t->data);
+    }
+    g_free(base);
+}
+
+static void notify_one(ObtWatch *w, ObtWatchTarget *t, const gchar *subpath,
+                       ObtWatchNotifyType type)
+{
+    GSList l;
+
+    l.data = (gpointer)subpath;
+    l.next = NULL;
+    notify(w, t, &l, type);
+}
+
+/*! Watches the nearest existing directory above the target's path, to find
+  out when the path is created */
+static gboolean target_wait(ObtWatchTarget *t)
+{
+    ObtWatch *w = t->w;
+    gchar *dir, *up;
+    gpointer key;
+    gint wd;
+
+    dir = g_path_get_dirname(t->base_path);
+    while ((wd = inotify_add_watch(w->fd, dir, WAIT_MASK)) < 0 &&
+           strcmp(dir, G_DIR_SEPARATOR_S) && strcmp(dir, "."))
+    {
+        up = g_path_get_dirname(dir);
+        g_free(dir);
+        dir = up;
+    }
+    g_free(dir);
+    if (wd < 0) return FALSE;
+    if (wd == t->wait_wd) return TRUE; /* still the same directory */
+
+    target_unwait(t);
+    t->wait_wd = wd;
+    key = GINT_TO_POINTER(wd);
+    g_hash_table_insert(w->waits, key,
+                        g_slist_prepend(g_hash_table_lookup(w->waits, key),
+                                        t));
+    return TRUE;
+}
+
+/*! Starts watching the target's path if it exists, reporting everything
+  inside it as added, or else waits for it to be created */
+static gboolean target_start(ObtWatchTarget *t, gboolean report)
+{
+    GSList *added = NULL;
+    gboolean waiting;
+
+    /* wait first, so that the path can't be created unseen in between */
+    waiting = target_wait(t);
+    if (!(t->root = file_new(t, "", report ? &added : NULL)))
+        return waiting;
+    target_unwait(t);
+
+    if (report) {
+        added = g_slist_prepend(added, g_strdup(""));
+        notify(t->w, t, added, OBT_WATCH_ADDED);
+        g_slist_foreach(added, (GFunc)g_free, NULL);
+        g_slist_free(added);
+    }
+    return TRUE;
+}
+
+/*! Looks again for the paths of the targets waiting on a directory, after
+  something was created in it or it was removed */
+static void wake_targets(ObtWatch *w, gint wd)
+{
+    GSList *waiting, *it;
+
+    /* the list changes as the targets move on */
+    waiting = g_slist_copy(g_hash_table_lookup(w->waits,
+                                               GINT_TO_POINTER(wd)));
+    for (it = waiting; it; it = g_slist_next(it)) {
+        /* skip any which were removed by a callback in the meantime */
+        if (g_slist_find(g_hash_table_lookup(w->waits, GINT_TO_POINTER(wd)),
+                         it->data))
+            target_start(it->data, TRUE);
+    }
+    g_slist_free(waiting);
+}
+
+/*! Watches every target again from scratch after the kernel's event queue
+  overflowed, and tells them that they missed something */
+static void lost_events(ObtWatch *w)
+{
+    GHashTableIter iter;
+    gpointer key;
+    GSList *paths, *it;
+
+    /* the callbacks can remove targets, so go by their paths */
+    paths = NULL;
+    g_hash_table_iter_init(&iter, w->targets);
+    while (g_hash_table_iter_next(&iter, &key, NULL))
+        paths = g_slist_prepend(paths, g_strdup(key));
+
+    for (it = paths; it; it = g_slist_next(it)) {
+        ObtWatchTarget *t = g_hash_table_lookup(w->targets, it->data);
+
+        if (t) {
+            /* directories created in the meantime aren't watched yet */
+            if (t->root) {
+                file_free(t->root);
+                t->root = NULL;
+            }
+            target_start(t, FALSE);
+            notify_one(w, t, "", OBT_WATCH_LOST);
+        }
+        g_free(it->data);
+    }
+    g_slist_free(paths);
+}
+
+static void handle_event(ObtWatch *w, struct inotify_event *ev)
+{
+    ObtWatchFile *f;
+    ObtWatchTarget *t;
+    gchar *sub;
+
+    if (ev->mask & IN_Q_OVERFLOW) {
+        lost_events(w);
+        return;
+    }
+
+    if (ev->mask & (IN_CREATE | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF |
+                    IN_IGNORED))
+        wake_targets(w, ev->wd);
+
+    if (!(f = g_hash_table_lookup(w->wds, &ev->wd)))
+        return; /* it was removed already */
+    t = f->t;
+
+    if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+        /* subdirectories are dealt with from their parent's events */
+        if (f == t->root) {
+            gchar *base = g_strdup(t->base_path);
+
+            t->root = NULL;
+            file_free(f);
+            notify_one(w, t, "", OBT_WATCH_SELF_REMOVED);
+            /* watch it again if it comes back */
+            if (g_hash_table_lookup(w->targets, base) == t)
+                target_start(t, TRUE);
+            g_free(base);
+        }
+        return;
+    }
+
+    if (!ev->len) {
+        /* an event on a watched file itself */
+        if (ev->mask & IN_CLOSE_WRITE && !t->dir_only && !f->children)
+            notify_one(w, t, f->subpath, OBT_WATCH_MODIFIED);
+        return;
+    }
+
+    sub = child_subpath(f, ev->name);
+    if (ev->mask & IN_ISDIR) {
+        if (ev->mask & (IN_CREATE | IN_MOVED_TO)) {
+            ObtWatchFile *c;
+            GSList *added = NULL;
+
+            if ((c = file_new(t, sub, &added)))
+                g_hash_table_insert(f->children, g_strdup(ev->name), c);
+            added = g_slist_prepend(added, sub);
+            notify(w, t, added, OBT_WATCH_ADDED);
+            g_slist_foreach(added, (GFunc)g_free, NULL);
+            g_slist_free(added);
+            return;
+        }
+        else if (ev->mask & (IN_DELETE | IN_MOVED_FROM)) {
+            g_hash_table_remove(f->children, ev->name);
+            notify_one(w, t, sub, OBT_WATCH_REMOVED);
+        }
+    }
+    else if (!t->dir_only) {
+        if (ev->mask & (IN_CREATE | IN_MOVED_TO))
+            notify_one(w, t, sub, OBT_WATCH_ADDED);
+        else if (ev->mask & (IN_DELETE | IN_MOVED_FROM))
+            notify_one(w, t, sub, OBT_WATCH_REMOVED);
+        else if (ev->mask & IN_CLOSE_WRITE)
+            notify_one(w, t, sub, OBT_WATCH_MODIFIED);
+    }
+    g_free(sub);
+}
+
+static gboolean read_events(GIOChannel *source, GIOCondition cond,
+                            gpointer data)
+{
+    ObtWatch *w = data;
+    /* aligned so that the events can be read out of it in place */
+    union {
+        struct inotify_event ev;
+        gchar buf[4096];
+    } u;
+    gssize len;
+
+    obt_watch_ref(w);
+    while ((len = read(w->fd, u.buf, sizeof(u.buf))) > 0) {
+        gssize i = 0;
+
+        while (i + (gssize)sizeof(struct inotify_event) <= len) {
+            struct inotify_event *ev = (struct inotify_event*)(u.buf + i);
+
+            handle_event(w, ev);
+            i += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+    obt_watch_unref(w);
+    return TRUE; /* don't remove the event source */
+}
+#endif
+
+gboolean obt_watch_add(ObtWatch *w, const gchar *path, gboolean dir_only,
+                       ObtWatchFunc func, gpointer data)
+{
+#ifdef HAVE_SYS_INOTIFY_H
+    ObtWatchTarget *t;
+
+    g_return_val_if_fail(path != NULL, FALSE);
+    g_return_val_if_fail(func != NULL, FALSE);
+
+    if (w->fd < 0) return FALSE;
+
+    t = g_slice_new(ObtWatchTarget);
+    t->w = w;
+    t->base_path = g_strdup(path);
+    t->dir_only = dir_only;
+    t->func = func;
+    t->data = data;
+    t->root = NULL;
+    t->wait_wd = -1;
+
+    /* replace any old watch on the same path */
+    g_hash_table_remove(w->targets, path);
+
+    if (!target_start(t, FALSE)) {
+        target_free(t);
+        return FALSE;
+    }
+    g_hash_table_insert(w->targets, t->base_path, t);
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+void obt_watch_remove(ObtWatch *w, const gchar *path)
+{
+    g_hash_table_remove(w->targets, path);
+}
@@ -0,0 +1,67 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   obt/watch.h for the Openbox window manager
+   Copyright (c) 2026        The Openbox developers
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#ifndef __obt_watch_h
+#define __obt_watch_h
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ObtWatch ObtWatch;
+
+typedef enum {
+    OBT_WATCH_ADDED, /*!< A file was added to a watched directory */
+    OBT_WATCH_REMOVED, /*!< A file was removed from a watched directory */
+    OBT_WATCH_MODIFIED, /*!< A watched file was written to */
+    OBT_WATCH_SELF_REMOVED, /*!< The watched path itself was removed */
+    OBT_WATCH_LOST /*!< Changes were lost because too many happened at once,
+                     so anything in the watched path may have changed.  The
+                     subpath is an empty string. */
+} ObtWatchNotifyType;
+
+/*! Called when a change is seen in a watched path.
+  @param base_path The path which was given to obt_watch_add()
+  @param subpath The changed file, relative to @base_path.  This is an empty
+                 string when @base_path itself changed.
+*/
+typedef void (*ObtWatchFunc)(ObtWatch *w, const gchar *base_path,
+                             const gchar *subpath, ObtWatchNotifyType type,
+                             gpointer data);
+
+ObtWatch* obt_watch_new(void);
+void obt_watch_ref(ObtWatch *w);
+void obt_watch_unref(ObtWatch *w);
+
+/*! Start watching a file or a directory.  Directories are watched along with
+  all of their subdirectories.  Changes are reported from the GLib main loop.
+  A path which doesn't exist, or which is removed, is watched again once it
+  is created, and everything in it is reported as added.
+  @param dir_only When TRUE, only report changes for directories, not for
+                  the files inside them.
+  @return FALSE if the path can not be watched, or if watching files is not
+          supported on this system.
+*/
+gboolean obt_watch_add(ObtWatch *w, const gchar *path, gboolean dir_only,
+                       ObtWatchFunc func, gpointer data);
+/*! Stop watching a path which was given to obt_watch_add() */
+void obt_watch_remove(ObtWatch *w, const gchar *path);
+
+G_END_DECLS
+
+#endif
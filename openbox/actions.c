@@ -26,6 +26,7 @@
 #include "focus.h"
 #include "openbox.h"
 #include "debug.h"
+#include "latency.h"
 
 #include "actions/all.h"
 
@@ -53,6 +54,9 @@ struct _ObActionsDefinition {
     ObActionsShutdownFunc shutdown;
     gboolean modifies_focused_window;
     gboolean can_stop;
+
+    /*! How long the action takes to run, found the first time it runs */
+    ObLatency *latency;
 };
 
 struct _ObActionsAct {
@@ -373,7 +377,19 @@ void actions_run_acts(GSList *acts,
 
         /* fire the action's run function with this data */
         if (ok) {
-            if (!act->def->run(&data, act->options)) {
+            gboolean stop;
+            gint64 start = latency_now();
+
+            stop = act->def->run(&data, act->options);
+
+            if (!act->def->latency) {
+                gchar *name = g_strconcat("action ", act->def->name, NULL);
+                act->def->latency = latency_find(name);
+                g_free(name);
+            }
+            latency_add(act->def->latency, start);
+
+            if (!stop) {
                 if (actions_act_is_interactive(act)) {
                     actions_interactive_end_act();
                 }
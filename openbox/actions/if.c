@@ -39,6 +39,8 @@ typedef enum {
 
 typedef struct {
     MatchType type;
+    /* Identifies the match in the clients' caches of match results */
+    guint id;
     union m {
         GPatternSpec *pattern;
         GRegex *regex;
@@ -121,6 +123,8 @@ static void setup_typed_match(TypedMatch *tm, xmlNodePtr n)
     gchar *s;
     if ((s = obt_xml_node_string(n))) {
         gchar *type = NULL;
+
+        tm->id = client_match_id_new();
         if (!obt_xml_attr_string(n, "type", &type) ||
             !g_ascii_strcasecmp(type, "pattern"))
         {
@@ -170,6 +174,22 @@ static gboolean check_typed_match(TypedMatch *tm, const gchar *s)
     g_assert_not_reached();
 }
 
+/*! Matches one of the client's strings, remembering the result until the
+  client's strings change */
+static gboolean check_client_match(TypedMatch *tm, ObClient *c,
+                                   const gchar *s)
+{
+    gboolean r;
+
+    if (tm->type == MATCH_TYPE_NONE)
+        return TRUE;
+    if (!client_match_lookup(c, tm->id, &r)) {
+        r = check_typed_match(tm, s);
+        client_match_store(c, tm->id, r);
+    }
+    return r;
+}
+
 static void setup_query(Options* o, xmlNodePtr node, QueryTarget target) {
     Query *q = g_slice_new0(Query);
     g_array_append_val(o->queries, q);
@@ -403,12 +423,16 @@ static gboolean run_func_if(ObActionsData *data, gpointer options)
         if (q->screendesktop_number)
             is_true &= screen_desktop == q->screendesktop_number - 1;
 
-        is_true &= check_typed_match(&q->title, query_target->original_title);
-        is_true &= check_typed_match(&q->class, query_target->class);
-        is_true &= check_typed_match(&q->name, query_target->name);
-        is_true &= check_typed_match(&q->role, query_target->role);
-        is_true &= check_typed_match(&q->type,
-                                     client_type_to_string(query_target));
+        is_true &= check_client_match(&q->title, query_target,
+                                      query_target->original_title);
+        is_true &= check_client_match(&q->class, query_target,
+                                      query_target->class);
+        is_true &= check_client_match(&q->name, query_target,
+                                      query_target->name);
+        is_true &= check_client_match(&q->role, query_target,
+                                      query_target->role);
+        is_true &= check_client_match(&q->type, query_target,
+                                      client_type_to_string(query_target));
 
         if (q->client_monitor)
             is_true &= client_monitor(query_target) == q->client_monitor - 1;
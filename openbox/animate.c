@@ -0,0 +1,184 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   animate.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox developers
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#include "animate.h"
+#include "obt/display.h"
+
+#include <X11/Xlib.h>
+#include <glib.h>
+
+/* animations due within this many microseconds of each other are stepped
+   together */
+#define ANIMATE_SLACK (ANIMATE_FRAME_TIME * 1000 / 2)
+
+typedef struct _ObAnimation ObAnimation;
+
+struct _ObAnimation {
+    guint id;
+    guint interval; /* in milliseconds */
+    gint64 due; /* when the next step should happen */
+    ObAnimateFunc func;
+    gpointer data;
+    GDestroyNotify done;
+    /* it was removed while the animations were being stepped, and will be
+       freed afterwards */
+    gboolean removed;
+};
+
+static GSList  *animations = NULL;
+static guint    next_id = 1;
+static guint    timer = 0;
+static gint64   timer_due = 0;
+static gboolean stepping = FALSE;
+
+static void schedule(void);
+
+void animate_shutdown(gboolean reconfig)
+{
+    if (reconfig) return;
+
+    while (animations)
+        animate_remove(((ObAnimation*)animations->data)->id);
+    if (timer) g_source_remove(timer);
+    timer = 0;
+}
+
+gint64 animate_time(void)
+{
+    /* this is CLOCK_MONOTONIC where it is available */
+    return g_get_monotonic_time();
+}
+
+static void finish(ObAnimation *a)
+{
+    a->removed = TRUE;
+    if (a->done) a->done(a->data);
+}
+
+static gboolean step(gpointer data)
+{
+    GSList *it, *next;
+    gint64 now;
+
+    timer = 0;
+    now = animate_time();
+
+    stepping = TRUE;
+    for (it = animations; it; it = g_slist_next(it)) {
+        ObAnimation *a = it->data;
+
+        if (a->removed || a->due > now + ANIMATE_SLACK) continue;
+
+        if (a->func(a->data, now)) {
+            a->due += a->interval * 1000;
+            /* don't try to catch up if we fell behind */
+            if (a->due <= now)
+                a->due = now + a->interval * 1000;
+        }
+        else
+            finish(a);
+    }
+    stepping = FALSE;
+
+    for (it = animations; it; it = next) {
+        ObAnimation *a = it->data;
+
+        next = g_slist_next(it);
+        if (a->removed) {
+            animations = g_slist_delete_link(animations, it);
+            g_slice_free(ObAnimation, a);
+        }
+    }
+
+    /* send everything the animations did at once */
+    XFlush(obt_display);
+
+    schedule();
+    return FALSE; /* don't repeat */
+}
+
+/*! Makes sure the timer will go off when the next animation is due */
+static void schedule(void)
+{
+    GSList *it;
+    gint64 due = 0, now;
+
+    if (stepping) return; /* it will be done after stepping */
+
+    for (it = animations; it; it = g_slist_next(it)) {
+        ObAnimation *a = it->data;
+
+        if (!a->removed && (!due || a->due < due))
+            due = a->due;
+    }
+
+    if (timer && (!due || due != timer_due)) {
+        g_source_remove(timer);
+        timer = 0;
+    }
+    if (due && !timer) {
+        now = animate_time();
+        timer_due = due;
+        timer = g_timeout_add_full(G_PRIORITY_DEFAULT,
+                                   due > now ? (due - now + 999) / 1000 : 0,
+                                   step, NULL, NULL);
+    }
+}
+
+guint animate_add(guint interval, ObAnimateFunc func, gpointer data,
+                  GDestroyNotify done)
+{
+    ObAnimation *a;
+
+    g_assert(func != NULL);
+
+    a = g_slice_new(ObAnimation);
+    a->id = next_id++;
+    if (!next_id) next_id = 1; /* 0 is never used */
+    a->interval = MAX(interval, 1);
+    a->due = animate_time() + a->interval * 1000;
+    a->func = func;
+    a->data = data;
+    a->done = done;
+    a->removed = FALSE;
+
+    animations = g_slist_append(animations, a);
+    schedule();
+    return a->id;
+}
+
+void animate_remove(guint id)
+{
+    GSList *it;
+
+    for (it = animations; it; it = g_slist_next(it)) {
+        ObAnimation *a = it->data;
+
+        if (a->id == id) {
+            if (a->removed) break;
+
+            finish(a);
+            if (!stepping) {
+                animations = g_slist_remove(animations, a);
+                g_slice_free(ObAnimation, a);
+                schedule();
+            }
+            break;
+        }
+    }
+}
@@ -0,0 +1,54 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   animate.h for the Openbox window manager
+   Copyright (c) 2026        The Openbox developers
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#ifndef __animate_h
+#define __animate_h
+
+#include <glib.h>
+
+/*! The time between frames for animations which want to be smooth, in
+  milliseconds */
+#define ANIMATE_FRAME_TIME (1000 / 60) /* 60 Hz */
+
+/*! Runs one step of an animation.
+  @param now The monotonic time in microseconds that the step is for.  All
+             the animations stepped together are given the same time.
+  @return TRUE to keep going, FALSE when the animation is done
+*/
+typedef gboolean (*ObAnimateFunc)(gpointer data, gint64 now);
+
+void animate_shutdown(gboolean reconfig);
+
+/*! Start an animation.  All running animations share a single timer, and
+  those which are due at about the same time are stepped together and their
+  X requests flushed once.
+  @param interval The time between steps, in milliseconds
+  @param done Called when the animation finishes or is removed
+  @return An id for the animation, which is never 0
+*/
+guint animate_add(guint interval, ObAnimateFunc func, gpointer data,
+                  GDestroyNotify done);
+
+/*! Stop an animation before it finishes, calling its done function */
+void animate_remove(guint id);
+
+/*! Returns the current time on the clock used for animations, in
+  microseconds */
+gint64 animate_time(void);
+
+#endif
@@ -32,6 +32,9 @@
 #include "prompt.h"
 #include "focus.h"
 #include "focus_cycle.h"
+#include "focus_cycle_popup.h"
+#include "publish.h"
+#include "recorder.h"
 #include "stacking.h"
 #include "openbox.h"
 #include "group.h"
@@ -73,6 +76,11 @@ GList          *client_list             = NULL;
 
 static GSList  *client_destroy_notifies = NULL;
 static RrImage *client_default_icon     = NULL;
+/*! Sets of the clients on each desktop, keyed by the desktop number, with the
+  clients on every desktop under DESKTOP_ALL */
+static GHashTable *desktop_clients      = NULL;
+/*! The last id given out by client_match_id_new() */
+static guint       match_last_id        = 0;
 
 static void client_get_all(ObClient *self, gboolean real);
 static void client_get_startup_id(ObClient *self);
@@ -106,6 +114,8 @@ static GSList *client_search_all_top_parents_internal(ObClient *self,
                                                       gboolean bylayer,
                                                       ObStackingLayer layer);
 static void client_call_notifies(ObClient *self, GSList *list);
+static void desktop_index_add(ObClient *self);
+static void desktop_index_remove(ObClient *self, guint desktop);
 static void client_ping_event(ObClient *self, gboolean dead);
 static void client_prompt_kill(ObClient *self);
 static gboolean client_can_steal_focus(ObClient *self,
@@ -113,6 +123,7 @@ static gboolean client_can_steal_focus(ObClient *self,
                                        gboolean request_from_user,
                                        Time steal_time, Time launch_time);
 static void client_setup_default_decor_and_functions(ObClient *self);
+static void client_forget_matches(ObClient *self);
 static void client_setup_decor_undecorated(ObClient *self);
 
 void client_startup(gboolean reconfig)
@@ -128,10 +139,65 @@ void client_startup(gboolean reconfig)
 
 void client_shutdown(gboolean reconfig)
 {
+    GList *it;
+
     RrImageUnref(client_default_icon);
     client_default_icon = NULL;
 
+    /* the actions holding the match ids are about to be freed, so forget
+       every cached result and start the ids over for the new config */
+    for (it = client_list; it; it = g_list_next(it))
+        client_forget_matches(it->data);
+    match_last_id = 0;
+
     if (reconfig) return;
+
+    if (desktop_clients) {
+        g_hash_table_destroy(desktop_clients);
+        desktop_clients = NULL;
+    }
+}
+
+static void desktop_index_add(ObClient *self)
+{
+    GHashTable *set;
+
+    if (!desktop_clients)
+        desktop_clients = g_hash_table_new_full(
+            g_direct_hash, g_direct_equal,
+            NULL, (GDestroyNotify)g_hash_table_destroy);
+
+    set = g_hash_table_lookup(desktop_clients,
+                              GUINT_TO_POINTER(self->desktop));
+    if (!set) {
+        set = g_hash_table_new(g_direct_hash, g_direct_equal);
+        g_hash_table_insert(desktop_clients,
+                            GUINT_TO_POINTER(self->desktop), set);
+    }
+    g_hash_table_insert(set, self, self);
+}
+
+static void desktop_index_remove(ObClient *self, guint desktop)
+{
+    GHashTable *set;
+
+    if (!desktop_clients) return;
+
+    set = g_hash_table_lookup(desktop_clients, GUINT_TO_POINTER(desktop));
+    if (set) {
+        g_hash_table_remove(set, self);
+        if (g_hash_table_size(set) == 0)
+            g_hash_table_remove(desktop_clients, GUINT_TO_POINTER(desktop));
+    }
+}
+
+GList* client_desktop_list(guint desktop)
+{
+    GHashTable *set = NULL;
+
+    if (desktop_clients)
+        set = g_hash_table_lookup(desktop_clients, GUINT_TO_POINTER(desktop));
+    return set ? g_hash_table_get_keys(set) : NULL;
 }
 
 static void client_call_notifies(ObClient *self, GSList *list)
@@ -182,7 +248,7 @@ void client_remove_destroy_notify_data(ObClientCallback func, gpointer data)
     }
 }
 
-void client_set_list(void)
+static void publish_client_list(void)
 {
     Window *windows, *win_it;
     GList *it;
@@ -202,7 +268,11 @@ void client_set_list(void)
 
     if (windows)
         g_free(windows);
+}
 
+void client_set_list(void)
+{
+    publish_later(publish_client_list);
     stacking_set_list();
 }
 
@@ -482,9 +552,6 @@ void client_manage(Window window, ObPrompt *prompt)
        on map. */
     OBT_PROP_SET32(self->window, NET_WM_DESKTOP, CARDINAL, self->desktop);
 
-    /* grab mouse bindings before showing the window */
-    mouse_grab_for_client(self, TRUE);
-
     if (!config_focus_under_mouse)
         ignore_start = event_start_ignore_all_enters();
 
@@ -524,7 +591,9 @@ void client_manage(Window window, ObPrompt *prompt)
 
     /* add to client list/map */
     client_list = g_list_append(client_list, self);
+    desktop_index_add(self);
     window_add(&self->window, CLIENT_AS_WINDOW(self));
+    focus_cycle_popup_prewarm(self);
 
     /* this has to happen after we're in the client_list */
     if (STRUT_EXISTS(self->strut))
@@ -626,6 +695,7 @@ void client_unmanage(ObClient *self)
     self->kill_prompt = NULL;
 
     client_list = g_list_remove(client_list, self);
+    desktop_index_remove(self, self->desktop);
     stacking_remove(self);
     window_remove(self->window);
 
@@ -728,6 +798,7 @@ void client_unmanage(ObClient *self)
     g_free(self->group_class);
     g_free(self->client_machine);
     g_free(self->sm_client_id);
+    if (self->match_cache) g_hash_table_destroy(self->match_cache);
     g_slice_free(ObClient, self);
 }
 
@@ -908,11 +979,13 @@ static gboolean client_can_steal_focus(ObClient *self,
 static ObAppSettings *client_get_settings_state(ObClient *self)
 {
     ObAppSettings *settings;
-    GSList *it;
+    GSList *it, *candidates;
 
     settings = config_create_app_settings();
 
-    for (it = config_per_app_settings; it; it = g_slist_next(it)) {
+    /* only the settings which can possibly match need to be checked */
+    candidates = config_per_app_candidates(self->name, self->class);
+    for (it = candidates; it; it = g_slist_next(it)) {
         ObAppSettings *app = it->data;
         gboolean match = TRUE;
 
@@ -957,6 +1030,7 @@ static ObAppSettings *client_get_settings_state(ObClient *self)
             config_app_settings_copy_non_defaults(app, settings);
         }
     }
+    g_slist_free(candidates);
 
     if (settings->shade != -1)
         self->shaded = !!settings->shade;
@@ -1629,6 +1703,8 @@ void client_get_type_and_transientness(ObClient *self)
     {
         self->transient = TRUE;
     }
+
+    client_forget_matches(self);
 }
 
 void client_update_protocols(ObClient *self)
@@ -2116,6 +2192,7 @@ void client_update_title(ObClient *self)
         }
     }
     self->original_title = g_strdup(data);
+    client_forget_matches(self);
 
     if (self->client_machine) {
         visible = g_strdup_printf("%s (%s)", data, self->client_machine);
@@ -2165,6 +2242,8 @@ void client_update_title(ObClient *self)
 
     OBT_PROP_SETS(self->window, NET_WM_VISIBLE_ICON_NAME, visible);
     self->icon_title = visible;
+
+    focus_cycle_popup_retitle(self);
 }
 
 void client_update_strut(ObClient *self)
@@ -2328,6 +2407,8 @@ void client_update_icons(ObClient *self)
         frame_adjust_icon(self->frame);
 
     grab_server(FALSE);
+
+    focus_cycle_popup_prewarm(self);
 }
 
 void client_update_icon_geometry(ObClient *self)
@@ -2407,6 +2488,8 @@ static void client_get_session_ids(ObClient *self)
     else
         self->role = g_strdup("");
 
+    client_forget_matches(self);
+
     /* get the WM_COMMAND */
     got = FALSE;
 
@@ -2458,6 +2541,37 @@ static void client_get_session_ids(ObClient *self)
     }
 }
 
+guint client_match_id_new(void)
+{
+    return ++match_last_id;
+}
+
+gboolean client_match_lookup(ObClient *self, guint id, gboolean *result)
+{
+    gpointer r;
+
+    if (!self->match_cache ||
+        !g_hash_table_lookup_extended(self->match_cache,
+                                      GUINT_TO_POINTER(id), NULL, &r))
+        return FALSE;
+    *result = GPOINTER_TO_INT(r);
+    return TRUE;
+}
+
+void client_match_store(ObClient *self, guint id, gboolean result)
+{
+    if (!self->match_cache)
+        self->match_cache = g_hash_table_new(g_direct_hash, g_direct_equal);
+    g_hash_table_insert(self->match_cache, GUINT_TO_POINTER(id),
+                        GINT_TO_POINTER(!!result));
+}
+
+static void client_forget_matches(ObClient *self)
+{
+    if (self->match_cache)
+        g_hash_table_remove_all(self->match_cache);
+}
+
 const gchar *client_type_to_string(ObClient *self)
 {
     const gchar *type;
@@ -2703,6 +2817,9 @@ void client_calc_layer(ObClient *self)
 {
     GList *it;
 
+    /* restack everything that changes layer together */
+    stacking_begin();
+
     /* skip over stuff above fullscreen layer */
     for (it = stacking_list; it; it = g_list_next(it))
         if (window_layer(it->data) <= OB_STACKING_LAYER_FULLSCREEN) break;
@@ -2728,6 +2845,8 @@ void client_calc_layer(ObClient *self)
                  !WINDOW_AS_CLIENT(it->data)->visited)
             client_calc_layer_internal(it->data);
     }
+
+    stacking_commit();
 }
 
 gboolean client_should_show(ObClient *self)
@@ -2751,6 +2870,9 @@ gboolean client_show(ObClient *self)
            should be going to something under the window */
         mouse_replay_pointer();
 
+        /* grab the mouse bindings if it wasn't shown before */
+        mouse_grab_for_client(self, TRUE);
+
         frame_show(self->frame);
         show = TRUE;
 
@@ -3177,6 +3299,8 @@ void client_configure(ObClient *self, gint x, gint y, gint w, gint h,
     /* find the new x, y, width, and height (and logical size) */
     client_try_configure(self, &x, &y, &w, &h, &logicalw, &logicalh, user);
 
+    recorder_record(OB_RECORD_CONFIGURE, user, self->window, x, y, w, h);
+
     /* set the logical size if things changed */
     if (!(w == self->area.width && h == self->area.height))
         SIZE_SET(self->logical_size, logicalw, logicalh);
@@ -3748,6 +3872,8 @@ static void client_set_desktop_recursive(ObClient *self,
 
         old = self->desktop;
         self->desktop = target;
+        desktop_index_remove(self, old);
+        desktop_index_add(self);
         OBT_PROP_SET32(self->window, NET_WM_DESKTOP, CARDINAL, target);
         /* the frame can display the current desktop state */
         frame_adjust_state(self->frame);
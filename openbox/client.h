@@ -25,6 +25,7 @@
 #include "geom.h"
 #include "stacking.h"
 #include "window.h"
+#include "moveresize.h"
 #include "obrender/color.h"
 
 #include <glib.h>
@@ -134,6 +135,11 @@ struct _ObClient
     /*! The session client id for the window. *This can be NULL!* */
     gchar *sm_client_id;
 
+    /*! Results of matching the window's original title, name, class, role
+      and type, keyed by the id of the matcher.  This is emptied whenever any
+      of them change.  *This can be NULL!* */
+    GHashTable *match_cache;
+
     /*! The type of window (what its function is) */
     ObClientType type;
 
@@ -250,6 +256,8 @@ struct _ObClient
     guint32 sync_counter;
     /*! The value we're waiting for the counter to reach */
     gulong sync_counter_value;
+    /*! How long the client has been taking to answer sync requests */
+    ObSyncLatency sync_latency;
 #endif
 
     /*! The window uses shape extension to be non-rectangular? */
@@ -316,6 +324,11 @@ struct _ObClient
 
     /*! A boolean used for algorithms which need to mark clients as visited */
     gboolean visited;
+
+    /*! The mouse bindings are grabbed on the client's windows.  This happens
+      when it is managed, or the first time it is shown if it was not shown
+      then */
+    gboolean mouse_grabbed;
 };
 
 extern GList      *client_list;
@@ -557,6 +570,11 @@ void client_kill(ObClient *self);
 void client_set_desktop(ObClient *self, guint target, gboolean donthide,
                         gboolean dontraise);
 
+/*! Returns a list of the clients on the given desktop, which can be
+  DESKTOP_ALL for the clients on every desktop.  The list is in no particular
+  order and must be freed with g_list_free(). */
+GList* client_desktop_list(guint desktop);
+
 /*! Show the client if it should be shown. Returns if the window is shown. */
 gboolean client_show(ObClient *self);
 
@@ -657,6 +675,17 @@ void client_update_icon_geometry(ObClient *self);
 /*! Helper function to convert the ->type member to string representation */
 const gchar *client_type_to_string(ObClient *self);
 
+/*! Returns a new id for something which matches the window's original title,
+  name, class, role or type, to cache its results with */
+guint client_match_id_new(void);
+/*! Gets the cached result of a match against the window's strings.
+  @return FALSE if the result is not known
+*/
+gboolean client_match_lookup(ObClient *self, guint id, gboolean *result);
+/*! Caches the result of a match against the window's strings, until they
+  change */
+void client_match_store(ObClient *self, guint id, gboolean result);
+
 /*! Set up what decor should be shown on the window and what functions should
   be allowed (ObClient::decorations and ObClient::functions).
   This also updates the NET_WM_ALLOWED_ACTIONS hint.
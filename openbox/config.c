@@ -28,6 +28,8 @@
 #include "gettext.h"
 #include "obt/paths.h"
 
+#include <string.h>
+
 gboolean config_focus_new;
 gboolean config_focus_follow;
 guint    config_focus_delay;
@@ -69,6 +71,8 @@ gboolean         config_resize_redraw;
 gint             config_resize_popup_show;
 ObResizePopupPos config_resize_popup_pos;
 GravityPoint     config_resize_popup_fixed;
+gint             config_resize_rate;
+gboolean         config_resize_outline;
 
 ObStackingLayer config_dock_layer;
 gboolean        config_dock_floating;
@@ -106,6 +110,22 @@ gint     config_resist_edge;
 
 GSList *config_per_app_settings;
 
+/*! Per app settings with a class that has no wildcards, keyed by the class */
+static GHashTable *per_app_by_class;
+/*! Per app settings with a name that has no wildcards, and which are not in
+  per_app_by_class, keyed by the name */
+static GHashTable *per_app_by_name;
+/*! Per app settings which aren't in either of the tables */
+static GSList *per_app_other;
+/*! The number of per app settings */
+static guint per_app_count;
+
+/*! Maps the name of each section in the rc.xml to a checksum of it */
+static GHashTable *section_sums = NULL;
+/*! The names of the sections which changed when the rc.xml was last loaded,
+  or NULL if there was nothing to compare to */
+static GHashTable *section_changes = NULL;
+
 ObAppSettings* config_create_app_settings(void)
 {
     ObAppSettings *settings = g_slice_new0(ObAppSettings);
@@ -345,6 +365,49 @@ static void parse_single_per_app_settings(xmlNodePtr app,
     }
 }
 
+static void per_app_index(GHashTable *table, const gchar *key,
+                          ObAppSettings *settings)
+{
+    GSList *list;
+
+    if ((list = g_hash_table_lookup(table, key)))
+        g_slist_append(list, settings); /* the head of the list stays */
+    else
+        g_hash_table_insert(table, g_strdup(key),
+                            g_slist_append(NULL, settings));
+}
+
+/*! Merges lists of per app settings, which are each in order, into one */
+static GSList* per_app_merge(GSList *a, GSList *b)
+{
+    GSList *ret = NULL;
+
+    while (a || b) {
+        if (!b || (a && ((ObAppSettings*)a->data)->order <
+                   ((ObAppSettings*)b->data)->order))
+        {
+            ret = g_slist_prepend(ret, a->data);
+            a = g_slist_next(a);
+        }
+        else {
+            ret = g_slist_prepend(ret, b->data);
+            b = g_slist_next(b);
+        }
+    }
+    return g_slist_reverse(ret);
+}
+
+GSList* config_per_app_candidates(const gchar *name, const gchar *class)
+{
+    GSList *by_class, *ret;
+
+    by_class = per_app_merge(g_hash_table_lookup(per_app_by_class, class),
+                             g_hash_table_lookup(per_app_by_name, name));
+    ret = per_app_merge(by_class, per_app_other);
+    g_slist_free(by_class);
+    return ret;
+}
+
 /* Manages settings for individual applications.
    Some notes: monitor is the screen number in a multi monitor
    (Xinerama) setup (starting from 0), or mouse: the monitor the pointer
@@ -403,6 +466,16 @@ static void parse_per_app_settings(xmlNodePtr node, gpointer d)
             continue;
 
         settings = config_create_app_settings();
+        settings->order = per_app_count++;
+
+        /* index the settings by their class or name when either of them
+           has to match exactly */
+        if (class_set && !strpbrk(class, "*?"))
+            per_app_index(per_app_by_class, class, settings);
+        else if (name_set && !strpbrk(name, "*?"))
+            per_app_index(per_app_by_name, name, settings);
+        else
+            per_app_other = g_slist_append(per_app_other, settings);
 
         if (name_set)
             settings->name = g_pattern_spec_new(name);
@@ -856,6 +929,14 @@ static void parse_resize(xmlNodePtr node, gpointer d)
             }
         }
     }
+    if ((n = obt_xml_find_node(node, "commitRate"))) {
+        if (obt_xml_node_contains(n, "Auto"))
+            config_resize_rate = -1;
+        else
+            config_resize_rate = MAX(obt_xml_node_int(n), 0);
+    }
+    if ((n = obt_xml_find_node(node, "outline")))
+        config_resize_outline = obt_xml_node_bool(n);
 }
 
 static void parse_dock(xmlNodePtr node, gpointer d)
@@ -1120,6 +1201,8 @@ void config_startup(ObtXmlInst *i)
     config_resize_popup_pos = OB_RESIZE_POS_CENTER;
     GRAVITY_COORD_SET(config_resize_popup_fixed.x, 0, FALSE, FALSE);
     GRAVITY_COORD_SET(config_resize_popup_fixed.y, 0, FALSE, FALSE);
+    config_resize_rate = 0; /* every motion event */
+    config_resize_outline = FALSE;
 
     obt_xml_register(i, "resize", parse_resize, NULL);
 
@@ -1171,10 +1254,98 @@ void config_startup(ObtXmlInst *i)
     obt_xml_register(i, "menu", parse_menu, NULL);
 
     config_per_app_settings = NULL;
+    per_app_by_class = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                             (GDestroyNotify)g_slist_free);
+    per_app_by_name = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                            (GDestroyNotify)g_slist_free);
+    per_app_other = NULL;
+    per_app_count = 0;
 
     obt_xml_register(i, "applications", parse_per_app_settings, NULL);
 }
 
+void config_compare_sections(xmlNodePtr root)
+{
+    GHashTable *sums;
+    GHashTableIter it;
+    gpointer key, value;
+    xmlNodePtr node;
+
+    /* sum up each of the sections, including repeated ones */
+    sums = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                 (GDestroyNotify)g_checksum_free);
+    for (node = root ? root->children : NULL; node; node = node->next) {
+        GChecksum *sum;
+        xmlBufferPtr buf;
+
+        if (node->type != XML_ELEMENT_NODE) continue;
+
+        if (!(sum = g_hash_table_lookup(sums, node->name))) {
+            sum = g_checksum_new(G_CHECKSUM_SHA1);
+            g_hash_table_insert(sums, g_strdup((const gchar*)node->name),
+                                sum);
+        }
+        buf = xmlBufferCreate();
+        xmlNodeDump(buf, node->doc, node, 0, 0);
+        g_checksum_update(sum, xmlBufferContent(buf), xmlBufferLength(buf));
+        xmlBufferFree(buf);
+    }
+
+    if (!section_changes)
+        section_changes = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                                g_free, NULL);
+    else
+        g_hash_table_remove_all(section_changes);
+
+    /* sections which are new or different */
+    g_hash_table_iter_init(&it, sums);
+    while (g_hash_table_iter_next(&it, &key, &value)) {
+        const gchar *old = section_sums ?
+            g_hash_table_lookup(section_sums, key) : NULL;
+        if (!old || strcmp(old, g_checksum_get_string(value)))
+            g_hash_table_insert(section_changes, g_strdup(key), NULL);
+    }
+    /* sections which are gone */
+    if (section_sums) {
+        g_hash_table_iter_init(&it, section_sums);
+        while (g_hash_table_iter_next(&it, &key, NULL))
+            if (!g_hash_table_lookup_extended(sums, key, NULL, NULL))
+                g_hash_table_insert(section_changes, g_strdup(key), NULL);
+        g_hash_table_destroy(section_sums);
+    }
+    else {
+        /* nothing to compare to, so everything changed */
+        g_hash_table_destroy(section_changes);
+        section_changes = NULL;
+    }
+
+    section_sums = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                         g_free);
+    g_hash_table_iter_init(&it, sums);
+    while (g_hash_table_iter_next(&it, &key, &value))
+        g_hash_table_insert(section_sums, g_strdup(key),
+                            g_strdup(g_checksum_get_string(value)));
+    g_hash_table_destroy(sums);
+}
+
+gboolean config_section_changed(const gchar *name)
+{
+    return !section_changes ||
+        g_hash_table_lookup_extended(section_changes, name, NULL, NULL);
+}
+
+void config_forget_sections(void)
+{
+    if (section_sums) {
+        g_hash_table_destroy(section_sums);
+        section_sums = NULL;
+    }
+    if (section_changes) {
+        g_hash_table_destroy(section_changes);
+        section_changes = NULL;
+    }
+}
+
 void config_shutdown(void)
 {
     GSList *it;
@@ -1209,4 +1380,8 @@ void config_shutdown(void)
         g_slice_free(ObAppSettings, it->data);
     }
     g_slist_free(config_per_app_settings);
+
+    g_hash_table_destroy(per_app_by_class);
+    g_hash_table_destroy(per_app_by_name);
+    g_slist_free(per_app_other);
 }
@@ -66,6 +66,9 @@ struct _ObAppSettings
     gint fullscreen;
 
     gint layer;
+
+    /* The position of the settings in the rc.xml */
+    guint order;
 };
 
 /*! Should new windows be focused */
@@ -113,6 +116,13 @@ extern gint config_resize_popup_show;
 extern ObResizePopupPos config_resize_popup_pos;
 /*! where to place the popup if it's in a fixed position */
 extern GravityPoint config_resize_popup_fixed;
+/*! How many times per second the window's geometry is changed during an
+  interactive move/resize.  0 = on every motion event, -1 = adapt to how fast
+  the client responds */
+extern gint config_resize_rate;
+/*! Draw an outline instead of configuring clients which can't keep up with
+  an interactive move/resize */
+extern gboolean config_resize_outline;
 
 /*! The stacking layer the dock will reside in */
 extern ObStackingLayer config_dock_layer;
@@ -216,9 +226,25 @@ extern GSList *config_menu_files;
 /*! Per app settings */
 extern GSList *config_per_app_settings;
 
+/*! Returns the per app settings which may match a window with the given
+  name and class, in the order they appear in config_per_app_settings.  Any
+  settings left out can not match the window.  Free the list with
+  g_slist_free(). */
+GSList* config_per_app_candidates(const gchar *name, const gchar *class);
+
 void config_startup(ObtXmlInst *i);
 void config_shutdown(void);
 
+/*! Compares each section of the loaded rc.xml with the last one loaded, to
+  find which of them changed.  The root may be NULL if nothing was loaded.
+*/
+void config_compare_sections(xmlNodePtr root);
+/*! Returns TRUE if the named section of the rc.xml changed the last time it
+  was loaded.  Everything has changed the first time. */
+gboolean config_section_changed(const gchar *name);
+/*! Forgets what the sections of the rc.xml held */
+void config_forget_sections(void);
+
 /*! Create an ObAppSettings structure with the default values */
 ObAppSettings* config_create_app_settings(void);
 /*! Copies any settings in src to dest, if they are their default value in
@@ -21,12 +21,14 @@
 #include "openbox.h"
 #include "gettext.h"
 #include "obt/paths.h"
+#include "obt/signal.h"
 
 #include <glib.h>
 #include <stdlib.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <errno.h>
+#include <string.h>
 
 #ifdef HAVE_UNISTD_H
 #  include <unistd.h>
@@ -41,10 +43,36 @@ static guint     ob_handler_prompt_id = 0;
 static GList    *prompt_queue = NULL;
 static gboolean  allow_prompts = TRUE;
 
+/* Debug messages are formatted straight into a ring of fixed size slots,
+   and written out from the main loop at the same priority as the X events,
+   so they are written out between events during a burst of them.  When the
+   ring is full, messages are counted and dropped instead of being written
+   out while an event is being handled. */
+#define LOG_SLOTS 1024
+#define LOG_SLOT_SIZE 512
+/* put at the end of a message which didn't fit in its slot */
+#define LOG_TRUNCATED "..."
+
+typedef struct {
+    gint len;
+    gchar text[LOG_SLOT_SIZE];
+} LogSlot;
+
+static LogSlot            log_slots[LOG_SLOTS];
+/* the next slot to fill, and the next slot to write out.  these only ever
+   count up, so the ring is full when they are LOG_SLOTS apart */
+static volatile guint     log_head = 0;
+static volatile guint     log_tail = 0;
+/* the number of messages dropped since the ring was last written out */
+static volatile guint     log_dropped = 0;
+static guint              log_idle_id = 0;
+
 static void log_handler(const gchar *log_domain, GLogLevelFlags log_level,
                         const gchar *message, gpointer user_data);
 static void prompt_handler(const gchar *log_domain, GLogLevelFlags log_level,
                            const gchar *message, gpointer user_data);
+static void log_flush(void);
+static void log_crash_flush(gint sig, gpointer data);
 
 void ob_debug_startup(void)
 {
@@ -78,12 +106,21 @@ void ob_debug_startup(void)
         g_log_set_handler("Openbox", G_LOG_LEVEL_MASK & ~G_LOG_LEVEL_DEBUG,
                           prompt_handler, NULL);
 
+    obt_signal_add_crash_handler(log_crash_flush, NULL);
+
     obt_paths_unref(p);
     g_free(dir);
 }
 
 void ob_debug_shutdown(void)
 {
+    obt_signal_remove_crash_handler(log_crash_flush);
+    if (log_idle_id) {
+        g_source_remove(log_idle_id);
+        log_idle_id = 0;
+    }
+    log_flush();
+
     g_log_remove_handler("ObRender", rr_handler_id);
     g_log_remove_handler("Obt", obt_handler_id);
     g_log_remove_handler("Openbox", ob_handler_id);
@@ -119,6 +156,9 @@ static void log_handler(const gchar *log_domain, GLogLevelFlags log_level,
     FILE *out;
     const gchar *level;
 
+    /* keep the messages in order */
+    log_flush();
+
     switch (log_level & G_LOG_LEVEL_MASK) {
     case G_LOG_LEVEL_DEBUG:    level = "Debug";    out = stdout; break;
     case G_LOG_LEVEL_INFO:     level = "Info";     out = stdout; break;
@@ -142,11 +182,82 @@ static void prompt_handler(const gchar *log_domain, GLogLevelFlags log_level,
         log_handler(log_domain, log_level, message, data);
 }
 
+/*! Writes out the debug messages in the ring, and how many were dropped
+  because it was full */
+static void log_flush(void)
+{
+    if (log_tail == log_head && !log_dropped) return;
+
+    while (log_tail != log_head) {
+        LogSlot *slot = &log_slots[log_tail % LOG_SLOTS];
+
+        fprintf(stdout, "Openbox-Debug: %s\n", slot->text);
+        if (log_file) fprintf(log_file, "Openbox-Debug: %s\n", slot->text);
+        ++log_tail;
+    }
+    /* the messages were dropped after all the ones in the ring */
+    if (log_dropped) {
+        fprintf(stdout, "Openbox-Debug: (%u messages dropped)\n",
+                log_dropped);
+        if (log_file)
+            fprintf(log_file, "Openbox-Debug: (%u messages dropped)\n",
+                    log_dropped);
+        log_dropped = 0;
+    }
+    fflush(stdout);
+    if (log_file) fflush(log_file);
+}
+
+static gboolean log_flush_idle(gpointer data)
+{
+    log_idle_id = 0;
+    log_flush();
+    return FALSE; /* don't repeat */
+}
+
+/*! Writes out the debug messages in the ring when openbox is crashing.  This
+  runs in a signal handler, so it only uses write() */
+static void log_crash_flush(gint sig, gpointer data)
+{
+    const gint fd = log_file ? fileno(log_file) : -1;
+
+    while (log_tail != log_head) {
+        LogSlot *slot = &log_slots[log_tail % LOG_SLOTS];
+
+        if (write(STDOUT_FILENO, "Openbox-Debug: ", 15) < 0 ||
+            write(STDOUT_FILENO, slot->text, slot->len) < 0 ||
+            write(STDOUT_FILENO, "\n", 1) < 0)
+        {
+            /* keep going for the log file */
+        }
+        if (fd >= 0 &&
+            (write(fd, "Openbox-Debug: ", 15) < 0 ||
+             write(fd, slot->text, slot->len) < 0 ||
+             write(fd, "\n", 1) < 0))
+        {
+            /* nowhere left to write to */
+        }
+        ++log_tail;
+    }
+    if (log_dropped) {
+        static const gchar msg[] = "Openbox-Debug: (messages dropped)\n";
+
+        if (write(STDOUT_FILENO, msg, sizeof(msg) - 1) < 0) {
+            /* keep going for the log file */
+        }
+        if (fd >= 0 && write(fd, msg, sizeof(msg) - 1) < 0) {
+            /* nowhere left to write to */
+        }
+    }
+}
+
 static inline void log_argv(ObDebugType type,
                             const gchar *format, va_list args)
 {
     const gchar *prefix;
-    gchar *message;
+    LogSlot *slot;
+    gsize plen;
+    gint len;
 
     g_assert(type < OB_DEBUG_TYPE_NUM);
     if (!enabled_types[type]) return;
@@ -158,15 +269,29 @@ static inline void log_argv(ObDebugType type,
     default:                prefix = NULL;                 break;
     }
 
-    message = g_strdup_vprintf(format, args);
-    if (prefix) {
-        gchar *a = message;
-        message = g_strconcat(prefix, message, NULL);
-        g_free(a);
+    if (log_head - log_tail == LOG_SLOTS)
+        /* the ring is full, and it will be said so when it is written out */
+        ++log_dropped;
+    else {
+        slot = &log_slots[log_head % LOG_SLOTS];
+        plen = prefix ? g_strlcpy(slot->text, prefix, LOG_SLOT_SIZE) : 0;
+        len = g_vsnprintf(slot->text + plen, LOG_SLOT_SIZE - plen,
+                          format, args);
+        if (len < 0)
+            len = 0;
+        else if ((gsize)len >= LOG_SLOT_SIZE - plen) {
+            /* it was cut off, so mark it */
+            len = LOG_SLOT_SIZE - plen - 1;
+            strcpy(slot->text + LOG_SLOT_SIZE - sizeof(LOG_TRUNCATED),
+                   LOG_TRUNCATED);
+        }
+        slot->len = plen + len;
+        ++log_head;
     }
 
-    g_debug("%s", message);
-    g_free(message);
+    if (!log_idle_id)
+        log_idle_id = g_idle_add_full(G_PRIORITY_DEFAULT, log_flush_idle,
+                                      NULL, NULL);
 }
 
 void ob_debug(const gchar *a, ...)
@@ -19,6 +19,8 @@
 
 #include "event.h"
 #include "debug.h"
+#include "recorder.h"
+#include "latency.h"
 #include "window.h"
 #include "openbox.h"
 #include "dock.h"
@@ -47,6 +49,7 @@
 #include <X11/Xlib.h>
 #include <X11/Xatom.h>
 #include <glib.h>
+#include <string.h>
 
 #ifdef HAVE_SYS_SELECT_H
 #  include <sys/select.h>
@@ -117,6 +120,29 @@ static ObClient *focus_delay_timeout_client = NULL;
 static guint unfocus_delay_timeout_id = 0;
 static ObClient *unfocus_delay_timeout_client = NULL;
 
+/*! How long it takes to handle each type of event, made when one is first
+  seen */
+static ObLatency *type_latency[128];
+/*! How long it takes each of the handlers to deal with an event */
+static ObLatency *client_latency;
+static ObLatency *dockapp_latency;
+static ObLatency *dock_latency;
+static ObLatency *menu_latency;
+static ObLatency *root_latency;
+
+static const gchar *event_type_names[] = {
+    NULL, NULL,
+    "KeyPress", "KeyRelease", "ButtonPress", "ButtonRelease",
+    "MotionNotify", "EnterNotify", "LeaveNotify", "FocusIn", "FocusOut",
+    "KeymapNotify", "Expose", "GraphicsExpose", "NoExpose",
+    "VisibilityNotify", "CreateNotify", "DestroyNotify", "UnmapNotify",
+    "MapNotify", "MapRequest", "ReparentNotify", "ConfigureNotify",
+    "ConfigureRequest", "GravityNotify", "ResizeRequest",
+    "CirculateNotify", "CirculateRequest", "PropertyNotify",
+    "SelectionClear", "SelectionRequest", "SelectionNotify",
+    "ColormapNotify", "ClientMessage", "MappingNotify"
+};
+
 #ifdef USE_SM
 static gboolean ice_handler(GIOChannel *source, GIOCondition cond,
                             gpointer conn)
@@ -155,6 +181,12 @@ void event_startup(gboolean reconfig)
 #endif
 
     client_add_destroy_notify(focus_delay_client_dest, NULL);
+
+    client_latency = latency_find("handler event_handle_client");
+    dockapp_latency = latency_find("handler event_handle_dockapp");
+    dock_latency = latency_find("handler event_handle_dock");
+    menu_latency = latency_find("handler event_handle_menu");
+    root_latency = latency_find("handler event_handle_root");
 }
 
 void event_shutdown(gboolean reconfig)
@@ -166,6 +198,28 @@ void event_shutdown(gboolean reconfig)
 #endif
 
     client_remove_destroy_notify(focus_delay_client_dest);
+
+    /* the histograms themselves belong to the latency code */
+    memset(type_latency, 0, sizeof(type_latency));
+}
+
+/*! Returns the histogram for the time it takes to handle this type of
+  event */
+static ObLatency* event_type_latency(gint type)
+{
+    gint i = type & 0x7f;
+
+    if (!type_latency[i]) {
+        gchar *name;
+
+        if (i < (gint)G_N_ELEMENTS(event_type_names) && event_type_names[i])
+            name = g_strconcat("event ", event_type_names[i], NULL);
+        else
+            name = g_strdup_printf("event %d", i);
+        type_latency[i] = latency_find(name);
+        g_free(name);
+    }
+    return type_latency[i];
 }
 
 static Window event_get_window(XEvent *e)
@@ -458,7 +512,11 @@ static void event_process(const XEvent *ec, gpointer data)
     ObWindow *obwin = NULL;
     ObMenuFrame *menu = NULL;
     ObPrompt *prompt = NULL;
+    ObLatency *handler = NULL;
     gboolean used;
+    gint64 start, handler_start;
+
+    start = latency_now();
 
     /* make a copy we can mangle */
     ee = *ec;
@@ -493,8 +551,11 @@ static void event_process(const XEvent *ec, gpointer data)
 
     event_set_curtime(e);
     event_curserial = e->xany.serial;
+    recorder_event(e->type, window, event_curserial, event_curtime);
     event_hack_mods(e);
 
+    handler_start = latency_now();
+
     /* deal with it in the kernel */
 
     if (e->type == FocusIn) {
@@ -622,16 +683,26 @@ static void event_process(const XEvent *ec, gpointer data)
         if (client && client != focus_client)
             frame_adjust_focus(client->frame, FALSE);
     }
-    else if (client)
+    else if (client) {
         event_handle_client(client, e);
-    else if (dockapp)
+        handler = client_latency;
+    }
+    else if (dockapp) {
         event_handle_dockapp(dockapp, e);
-    else if (dock)
+        handler = dockapp_latency;
+    }
+    else if (dock) {
         event_handle_dock(dock, e);
-    else if (menu)
+        handler = dock_latency;
+    }
+    else if (menu) {
         event_handle_menu(menu, e);
-    else if (window == obt_root(ob_screen))
+        handler = menu_latency;
+    }
+    else if (window == obt_root(ob_screen)) {
         event_handle_root(e);
+        handler = root_latency;
+    }
     else if (e->type == MapRequest)
         window_manage(window);
     else if (e->type == MappingNotify) {
@@ -683,10 +754,10 @@ static void event_process(const XEvent *ec, gpointer data)
 
         /* we are not to be held responsible if someone sends us an
            invalid request! */
-        obt_display_ignore_errors(TRUE);
+        obt_display_trap_push();
         XConfigureWindow(obt_display, window,
                          e->xconfigurerequest.value_mask, &xwc);
-        obt_display_ignore_errors(FALSE);
+        obt_display_trap_pop_ignored();
     }
 #ifdef SYNC
     else if (obt_display_extension_sync &&
@@ -698,6 +769,8 @@ static void event_process(const XEvent *ec, gpointer data)
     }
 #endif
 
+    if (handler) latency_add(handler, handler_start);
+
     if (e->type == ButtonPress || e->type == ButtonRelease) {
         ObWindow *w;
         static guint pressed = 0;
@@ -743,6 +816,8 @@ static void event_process(const XEvent *ec, gpointer data)
        the time, so clear it here until the next event is handled */
     event_curtime = event_sourcetime = CurrentTime;
     event_curserial = 0;
+
+    latency_add(event_type_latency(e->type), start);
 }
 
 static void event_handle_root(XEvent *e)
@@ -789,6 +864,10 @@ static void event_handle_root(XEvent *e)
                 ob_restart();
             else if (e->xclient.data.l[0] == 3)
                 ob_exit(0);
+            else if (e->xclient.data.l[0] == 4)
+                recorder_dump();
+            else if (e->xclient.data.l[0] == 5)
+                latency_dump();
         } else if (msgtype == OBT_PROP_ATOM(WM_PROTOCOLS)) {
             if ((Atom)e->xclient.data.l[0] == OBT_PROP_ATOM(NET_WM_PING))
                 ping_got_pong(e->xclient.data.l[1]);
@@ -18,6 +18,7 @@
 */
 
 #include "debug.h"
+#include "recorder.h"
 #include "event.h"
 #include "openbox.h"
 #include "grab.h"
@@ -79,6 +80,9 @@ void focus_set_client(ObClient *client)
     if (focus_client == client)
         return;
 
+    recorder_record(OB_RECORD_FOCUS, 0, client ? client->window : 0,
+                    focus_client ? focus_client->window : 0, 0, 0, 0);
+
     /* uninstall the old colormap, and install the new one */
     screen_install_colormap(focus_client, FALSE);
     screen_install_colormap(client, TRUE);
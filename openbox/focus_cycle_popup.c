@@ -31,6 +31,7 @@
 
 #include <X11/Xlib.h>
 #include <glib.h>
+#include <string.h>
 
 /* Size of the icons, which can appear inside or outside of a hilite box */
 #define ICON_SIZE (gint)config_theme_window_list_icon_size
@@ -61,6 +62,13 @@ struct _ObFocusCyclePopupTarget
     Window iconwin;
     /* This is used when the popup is in list mode */
     Window textwin;
+    /* The position of the target in the list */
+    gint pos;
+    /* The position the target was last drawn at, or -1 if it needs to be
+       drawn again */
+    gint drawn;
+    /* The measured width of the text, or -1 if it needs to be measured */
+    gint textw;
 };
 
 struct _ObFocusCyclePopup
@@ -76,6 +84,13 @@ struct _ObFocusCyclePopup
 
     GList *targets;
     gint n_targets;
+    /* Maps each ObClient in the targets to its link in the list */
+    GHashTable *target_map;
+    /* Targets kept ready while the popup is hidden, keyed by ObClient */
+    GHashTable *warm;
+    /* Clients whose warm targets need to be created or updated */
+    GHashTable *warm_queue;
+    guint warm_id;
 
     const ObFocusCyclePopupTarget *last_target;
 
@@ -89,6 +104,8 @@ struct _ObFocusCyclePopup
     RrAppearance *a_hilite_text;
     RrAppearance *a_icon;
     RrAppearance *a_arrow;
+    /* Used to draw icons off-screen, so their scaled versions are cached */
+    RrAppearance *a_warm;
 
     gboolean mapped;
     ObFocusCyclePopupMode mode;
@@ -106,6 +123,8 @@ static gboolean popup_setup    (ObFocusCyclePopup *p,
                                 gboolean linear);
 static void     popup_render   (ObFocusCyclePopup *p,
                                 const ObClient *c);
+static void     popup_target_free(ObFocusCyclePopupTarget *t);
+static void     client_dest    (ObClient *client, gpointer data);
 
 static Window create_window(Window parent, guint bwidth, gulong mask,
                             XSetWindowAttributes *attr)
@@ -128,6 +147,7 @@ void focus_cycle_popup_startup(gboolean reconfig)
     popup.a_text = RrAppearanceCopy(ob_rr_theme->osd_unhilite_label);
     popup.a_icon = RrAppearanceCopy(ob_rr_theme->a_clear);
     popup.a_arrow = RrAppearanceCopy(ob_rr_theme->a_clear_tex);
+    popup.a_warm = RrAppearanceNew(ob_rr_inst, 1);
 
     popup.a_hilite_text->surface.parent = popup.a_bg;
     popup.a_text->surface.parent = popup.a_bg;
@@ -148,6 +168,13 @@ void focus_cycle_popup_startup(gboolean reconfig)
     popup.a_arrow->texture[0].data.mask.color =
         ob_rr_theme->osd_text_active_color;
 
+    popup.a_warm->surface.grad = RR_SURFACE_SOLID;
+    popup.a_warm->surface.primary = RrColorNew(ob_rr_inst, 0, 0, 0);
+    popup.a_warm->texture[0].type = RR_TEXTURE_IMAGE;
+    popup.a_warm->texture[0].data.image.twidth = ICON_SIZE;
+    popup.a_warm->texture[0].data.image.theight = ICON_SIZE;
+    popup.a_warm->texture[0].data.image.alpha = 0xff;
+
     attrib.override_redirect = True;
     attrib.border_pixel=RrColorPixel(ob_rr_theme->osd_border_color);
     popup.bg = create_window(obt_root(ob_screen), ob_rr_theme->obwidth,
@@ -162,6 +189,11 @@ void focus_cycle_popup_startup(gboolean reconfig)
 
     popup.targets = NULL;
     popup.n_targets = 0;
+    popup.target_map = g_hash_table_new(g_direct_hash, g_direct_equal);
+    popup.warm = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                       (GDestroyNotify)popup_target_free);
+    popup.warm_queue = g_hash_table_new(g_direct_hash, g_direct_equal);
+    popup.warm_id = 0;
     popup.last_target = NULL;
 
     /* set up the hilite texture for the icon */
@@ -205,12 +237,34 @@ void focus_cycle_popup_startup(gboolean reconfig)
 
     stacking_add(INTERNAL_AS_WINDOW(&popup));
     window_add(&popup.bg, INTERNAL_AS_WINDOW(&popup));
+
+    if (!reconfig)
+        client_add_destroy_notify(client_dest, NULL);
+    else {
+        GList *it;
+
+        /* the theme may have changed, so get everything ready again */
+        for (it = client_list; it; it = g_list_next(it))
+            focus_cycle_popup_prewarm(it->data);
+    }
 }
 
 void focus_cycle_popup_shutdown(gboolean reconfig)
 {
     icon_popup_free(single_popup);
 
+    if (!reconfig)
+        client_remove_destroy_notify(client_dest);
+
+    if (popup.warm_id) {
+        g_source_remove(popup.warm_id);
+        popup.warm_id = 0;
+    }
+    g_hash_table_destroy(popup.warm_queue);
+    popup.warm_queue = NULL;
+    g_hash_table_destroy(popup.warm);
+    popup.warm = NULL;
+
     window_remove(popup.bg);
     stacking_remove(INTERNAL_AS_WINDOW(&popup));
 
@@ -225,6 +279,8 @@ void focus_cycle_popup_shutdown(gboolean reconfig)
 
         popup.targets = g_list_delete_link(popup.targets, popup.targets);
     }
+    g_hash_table_destroy(popup.target_map);
+    popup.target_map = NULL;
 
     g_free(popup.a_icon->texture[1].data.rgba.data);
     popup.a_icon->texture[1].data.rgba.data = NULL;
@@ -234,6 +290,7 @@ void focus_cycle_popup_shutdown(gboolean reconfig)
     XDestroyWindow(obt_display, popup.icon_mode_text);
     XDestroyWindow(obt_display, popup.bg);
 
+    RrAppearanceFree(popup.a_warm);
     RrAppearanceFree(popup.a_arrow);
     RrAppearanceFree(popup.a_icon);
     RrAppearanceFree(popup.a_hilite_text);
@@ -250,24 +307,112 @@ static void popup_target_free(ObFocusCyclePopupTarget *t)
     g_slice_free(ObFocusCyclePopupTarget, t);
 }
 
+/*! Brings a target's text and icon up to date with its client, measuring
+  the text only if it changed */
+static void popup_target_update(ObFocusCyclePopup *p,
+                                ObFocusCyclePopupTarget *t)
+{
+    gchar *text;
+    RrImage *icon;
+
+    text = popup_get_name(t->client);
+    if (strcmp(text, t->text)) {
+        g_free(t->text);
+        t->text = text;
+        t->textw = -1;
+    }
+    else
+        g_free(text);
+
+    if (t->textw < 0) {
+        p->a_text->texture[0].data.text.string = t->text;
+        t->textw = RrMinWidth(p->a_text);
+    }
+
+    icon = client_icon(t->client);
+    if (icon != t->icon) {
+        RrImageRef(icon);
+        RrImageUnref(t->icon);
+        t->icon = icon;
+    }
+}
+
+/*! Returns the warm target for the client if there is one, or else makes a
+  new one.  Either way it is up to date and no longer in the warm table. */
+static ObFocusCyclePopupTarget* popup_target_take(ObFocusCyclePopup *p,
+                                                  ObClient *c)
+{
+    ObFocusCyclePopupTarget *t;
+
+    if ((t = g_hash_table_lookup(p->warm, c)))
+        g_hash_table_steal(p->warm, c);
+    else {
+        t = g_slice_new(ObFocusCyclePopupTarget);
+        t->client = c;
+        t->text = g_strdup("");
+        t->icon = NULL;
+        t->iconwin = create_window(p->bg, 0, 0, NULL);
+        t->textwin = create_window(p->bg, 0, 0, NULL);
+        t->pos = t->drawn = -1;
+        t->textw = -1;
+    }
+    g_hash_table_remove(p->warm_queue, c);
+
+    popup_target_update(p, t);
+    return t;
+}
+
+static gboolean popup_prewarm(gpointer data)
+{
+    GHashTableIter it;
+    gpointer key;
+    gint n;
+
+    /* do a few at a time so events aren't held up by a lot of new windows */
+    n = 0;
+    g_hash_table_iter_init(&it, popup.warm_queue);
+    while (n < 8 && g_hash_table_iter_next(&it, &key, NULL)) {
+        ObClient *c = key;
+        ObFocusCyclePopupTarget *t;
+
+        g_hash_table_iter_remove(&it);
+
+        /* targets in the popup are kept up to date already */
+        if (popup.mapped && g_hash_table_lookup(popup.target_map, c))
+            continue;
+
+        t = popup_target_take(&popup, c);
+        g_hash_table_insert(popup.warm, c, t);
+
+        /* draw the icon where it won't be seen, which leaves its scaled
+           version in the image cache */
+        popup.a_warm->texture[0].data.image.image = t->icon;
+        RrPaint(popup.a_warm, t->iconwin, ICON_SIZE, ICON_SIZE);
+        ++n;
+    }
+
+    if (g_hash_table_size(popup.warm_queue))
+        return TRUE; /* keep going */
+    popup.warm_id = 0;
+    return FALSE; /* finished */
+}
+
 static gboolean popup_setup(ObFocusCyclePopup *p, gboolean create_targets,
                             gboolean refresh_targets, gboolean linear)
 {
     gint maxwidth, n;
     GList *it;
     GList *rtargets; /* old targets for refresh */
-    GList *rtlast;
     gboolean change;
 
     if (refresh_targets) {
         rtargets = p->targets;
-        rtlast = g_list_last(rtargets);
         p->targets = NULL;
         p->n_targets = 0;
         change = FALSE;
     }
     else {
-        rtargets = rtlast = NULL;
+        rtargets = NULL;
         change = TRUE;
     }
 
@@ -290,47 +435,33 @@ static gboolean popup_setup(ObFocusCyclePopup *p, gboolean create_targets,
             GList *rit;
 
             /* reuse the target if possible during refresh */
-            for (rit = rtlast; rit; rit = g_list_previous(rit)) {
-                ObFocusCyclePopupTarget *t = rit->data;
-                if (t->client == ft) {
-                    if (rit == rtlast)
-                        rtlast = g_list_previous(rit);
-                    rtargets = g_list_remove_link(rtargets, rit);
-
-                    p->targets = g_list_concat(rit, p->targets);
-                    ++n;
-
-                    if (rit != rtlast)
-                        change = TRUE; /* order changed */
-                    break;
-                }
+            rit = refresh_targets ?
+                g_hash_table_lookup(p->target_map, ft) : NULL;
+            if (rit) {
+                rtargets = g_list_remove_link(rtargets, rit);
+                p->targets = g_list_concat(rit, p->targets);
+                ++n;
             }
-
-            if (!rit) {
+            else if (!create_targets) {
                 gchar *text = popup_get_name(ft);
 
                 /* measure */
                 p->a_text->texture[0].data.text.string = text;
                 maxwidth = MAX(maxwidth, RrMinWidth(p->a_text));
+                g_free(text);
+            }
+            else {
+                /* use the warm target if there is one, so the text is
+                   already measured and the windows already made */
+                ObFocusCyclePopupTarget *t = popup_target_take(p, ft);
 
-                if (!create_targets) {
-                    g_free(text);
-                } else {
-                    ObFocusCyclePopupTarget *t =
-                        g_slice_new(ObFocusCyclePopupTarget);
-
-                    t->client = ft;
-                    t->text = text;
-                    t->icon = client_icon(t->client);
-                    RrImageRef(t->icon); /* own the icon so it won't go away */
-                    t->iconwin = create_window(p->bg, 0, 0, NULL);
-                    t->textwin = create_window(p->bg, 0, 0, NULL);
+                maxwidth = MAX(maxwidth, t->textw);
 
-                    p->targets = g_list_prepend(p->targets, t);
-                    ++n;
+                p->targets = g_list_prepend(p->targets, t);
+                g_hash_table_insert(p->target_map, ft, p->targets);
+                ++n;
 
-                    change = TRUE; /* added a window */
-                }
+                change = TRUE; /* added a window */
             }
         }
     }
@@ -339,11 +470,24 @@ static gboolean popup_setup(ObFocusCyclePopup *p, gboolean create_targets,
         change = TRUE; /* removed a window */
 
         while (rtargets) {
-            popup_target_free(rtargets->data);
+            ObFocusCyclePopupTarget *t = rtargets->data;
+
+            g_hash_table_remove(p->target_map, t->client);
+            popup_target_free(t);
             rtargets = g_list_delete_link(rtargets, rtargets);
         }
     }
 
+    /* number the targets, and see if any of them moved */
+    for (n = 0, it = p->targets; it; ++n, it = g_list_next(it)) {
+        ObFocusCyclePopupTarget *t = it->data;
+
+        if (t->pos != n) {
+            t->pos = n;
+            change = TRUE; /* order changed */
+        }
+    }
+
     p->n_targets = n;
     if (refresh_targets)
         /* don't shrink when refreshing */
@@ -356,10 +500,18 @@ static gboolean popup_setup(ObFocusCyclePopup *p, gboolean create_targets,
 
 static void popup_cleanup(void)
 {
+    /* keep the targets ready for the next time the popup is shown */
     while(popup.targets) {
-        popup_target_free(popup.targets->data);
+        ObFocusCyclePopupTarget *t = popup.targets->data;
+
+        XUnmapWindow(obt_display, t->iconwin);
+        XUnmapWindow(obt_display, t->textwin);
+        t->pos = t->drawn = -1;
+        g_hash_table_insert(popup.warm, t->client, t);
+
         popup.targets = g_list_delete_link(popup.targets, popup.targets);
     }
+    g_hash_table_remove_all(popup.target_map);
     popup.n_targets = 0;
     popup.last_target = NULL;
 }
@@ -484,17 +636,10 @@ static void popup_render(ObFocusCyclePopup *p, const ObClient *c)
         h += OUTSIDE_BORDER + texth;
 
     /* find the focused target */
-    newtarget = NULL;
-    for (i = 0, it = p->targets; it; ++i, it = g_list_next(it)) {
-        const ObFocusCyclePopupTarget *target = it->data;
-        if (target->client == c) {
-            /* save the target */
-            newtarget = target;
-            break;
-        }
-    }
-    selected_pos = i;
-    g_assert(newtarget != NULL);
+    it = g_hash_table_lookup(p->target_map, c);
+    g_assert(it != NULL);
+    newtarget = it->data;
+    selected_pos = newtarget->pos;
 
     /* scroll the list if needed */
     last_scroll = p->scroll;
@@ -610,12 +755,12 @@ static void popup_render(ObFocusCyclePopup *p, const ObClient *c)
 
     /* draw the icons and text */
     for (i = 0, it = p->targets; it; ++i, it = g_list_next(it)) {
-        const ObFocusCyclePopupTarget *target = it->data;
+        ObFocusCyclePopupTarget *target = it->data;
 
         /* have to redraw the targetted icon and last targetted icon
-         * to update the hilite */
+         * to update the hilite, and anything that moved or changed */
         if (!p->mapped || newtarget == target || p->last_target == target ||
-            last_scroll != p->scroll)
+            last_scroll != p->scroll || target->drawn != i)
         {
             /* row and column start from 0 */
             const gint row = i / icons_per_row - p->scroll;
@@ -696,6 +841,8 @@ static void popup_render(ObFocusCyclePopup *p, const ObClient *c)
                          p->icon_mode_text : target->textwin),
                         textw, texth);
             }
+
+            target->drawn = i;
         }
     }
 
@@ -782,43 +929,31 @@ void focus_cycle_popup_single_hide(void)
 
 gboolean focus_cycle_popup_is_showing(ObClient *c)
 {
-    if (popup.mapped) {
-        GList *it;
-
-        for (it = popup.targets; it; it = g_list_next(it)) {
-            ObFocusCyclePopupTarget *t = it->data;
-            if (t->client == c)
-                return TRUE;
-        }
-    }
-    return FALSE;
+    return popup.mapped && g_hash_table_lookup(popup.target_map, c);
 }
 
 static ObClient* popup_revert(ObClient *target)
 {
     GList *it, *itt;
 
-    for (it = popup.targets; it; it = g_list_next(it)) {
-        ObFocusCyclePopupTarget *t = it->data;
-        if (t->client == target) {
-            /* move to a previous window if possible */
-            for (itt = it->prev; itt; itt = g_list_previous(itt)) {
-                ObFocusCyclePopupTarget *t2 = itt->data;
-                if (focus_cycle_valid(t2->client))
-                    return t2->client;
-            }
+    if (!(it = g_hash_table_lookup(popup.target_map, target)))
+        return NULL;
 
-            /* otherwise move to a following window if possible */
-            for (itt = it->next; itt; itt = g_list_next(itt)) {
-                ObFocusCyclePopupTarget *t2 = itt->data;
-                if (focus_cycle_valid(t2->client))
-                    return t2->client;
-            }
+    /* move to a previous window if possible */
+    for (itt = it->prev; itt; itt = g_list_previous(itt)) {
+        ObFocusCyclePopupTarget *t2 = itt->data;
+        if (focus_cycle_valid(t2->client))
+            return t2->client;
+    }
 
-            /* otherwise, we can't go anywhere there is nowhere valid to go */
-            return NULL;
-        }
+    /* otherwise move to a following window if possible */
+    for (itt = it->next; itt; itt = g_list_next(itt)) {
+        ObFocusCyclePopupTarget *t2 = itt->data;
+        if (focus_cycle_valid(t2->client))
+            return t2->client;
     }
+
+    /* otherwise, we can't go anywhere there is nowhere valid to go */
     return NULL;
 }
 
@@ -826,22 +961,76 @@ ObClient* focus_cycle_popup_refresh(ObClient *target,
                                     gboolean redraw,
                                     gboolean linear)
 {
+    gint n, w;
+
     if (!popup.mapped) return NULL;
 
     if (!focus_cycle_valid(target))
         target = popup_revert(target);
 
+    n = popup.n_targets;
+    w = popup.maxtextw;
     redraw = popup_setup(&popup, TRUE, TRUE, linear) && redraw;
 
     if (!target && popup.targets)
         target = ((ObFocusCyclePopupTarget*)popup.targets->data)->client;
 
     if (target && redraw) {
-        popup.mapped = FALSE;
-        popup_render(&popup, target);
-        XFlush(obt_display);
-        popup.mapped = TRUE;
+        /* only redraw the whole dialog if its size changed, otherwise just
+           the targets which moved are drawn again */
+        if (n != popup.n_targets || w != popup.maxtextw) {
+            popup.mapped = FALSE;
+            popup_render(&popup, target);
+            popup.mapped = TRUE;
+        }
+        else
+            popup_render(&popup, target);
     }
 
     return target;
 }
+
+void focus_cycle_popup_retitle(ObClient *c)
+{
+    GList *it;
+    ObFocusCyclePopupTarget *t;
+    gint w;
+
+    if (!popup.mapped || !(it = g_hash_table_lookup(popup.target_map, c))) {
+        focus_cycle_popup_prewarm(c);
+        return;
+    }
+
+    t = it->data;
+    g_free(t->text);
+    t->text = popup_get_name(c);
+    t->drawn = -1;
+
+    /* grow to fit the new title if needed */
+    popup.a_text->texture[0].data.text.string = t->text;
+    t->textw = w = RrMinWidth(popup.a_text);
+    if (w > popup.maxtextw) {
+        popup.maxtextw = w;
+        popup.mapped = FALSE;
+    }
+    popup_render(&popup, popup.last_target->client);
+    popup.mapped = TRUE;
+}
+
+void focus_cycle_popup_prewarm(ObClient *c)
+{
+    /* only clients which are fully managed */
+    if (window_find(c->window) != CLIENT_AS_WINDOW(c))
+        return;
+
+    g_hash_table_insert(popup.warm_queue, c, c);
+    if (!popup.warm_id)
+        popup.warm_id = g_idle_add_full(G_PRIORITY_LOW, popup_prewarm,
+                                        NULL, NULL);
+}
+
+static void client_dest(ObClient *client, gpointer data)
+{
+    g_hash_table_remove(popup.warm_queue, client);
+    g_hash_table_remove(popup.warm, client);
+}
@@ -50,4 +50,11 @@ struct _ObClient *focus_cycle_popup_refresh(struct _ObClient *target,
                                             gboolean redraw,
                                             gboolean linear);
 
+/*! Updates the title shown for the client, if it is in the popup */
+void focus_cycle_popup_retitle(struct _ObClient *c);
+
+/*! Gets the popup's contents for the client ready ahead of time, when
+  there is nothing else to do, so the popup can be shown quickly */
+void focus_cycle_popup_prewarm(struct _ObClient *c);
+
 #endif
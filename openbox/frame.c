@@ -24,6 +24,7 @@
 #include "debug.h"
 #include "config.h"
 #include "framerender.h"
+#include "animate.h"
 #include "focus_cycle.h"
 #include "focus_cycle_indicator.h"
 #include "moveresize.h"
@@ -41,17 +42,16 @@
                            EnterWindowMask | LeaveWindowMask)
 
 #define FRAME_ANIMATE_ICONIFY_TIME 150000 /* .15 seconds */
-#define FRAME_ANIMATE_ICONIFY_STEP_TIME (1000 / 60) /* 60 Hz */
 
 #define FRAME_HANDLE_Y(f) (f->size.top + f->client->area.height + f->cbwidth_b)
 
 static void flash_done(gpointer data);
-static gboolean flash_timeout(gpointer data);
+static gboolean flash_timeout(gpointer data, gint64 now);
 
 static void layout_title(ObFrame *self);
 static void set_theme_statics(ObFrame *self);
 static void free_theme_statics(ObFrame *self);
-static gboolean frame_animate_iconify(gpointer self);
+static gboolean frame_animate_iconify(gpointer self, gint64 now);
 static void frame_adjust_cursors(ObFrame *self);
 
 static Window createWindow(Window parent, Visual *visual,
@@ -1074,7 +1074,7 @@ void frame_release_client(ObFrame *self)
 {
     /* if there was any animation going on, kill it */
     if (self->iconify_animation_timer)
-        g_source_remove(self->iconify_animation_timer);
+        animate_remove(self->iconify_animation_timer);
 
     /* check if the app has already reparented its window away */
     if (!xqueue_exists_local(find_reparent, self)) {
@@ -1131,7 +1131,7 @@ void frame_release_client(ObFrame *self)
     window_remove(self->rgriptop);
     window_remove(self->rgripbottom);
 
-    if (self->flash_timer) g_source_remove(self->flash_timer);
+    if (self->flash_timer) animate_remove(self->flash_timer);
 }
 
 /* is there anything present between us and the label? */
@@ -1667,15 +1667,11 @@ static void flash_done(gpointer data)
     self->flash_timer = 0;
 }
 
-static gboolean flash_timeout(gpointer data)
+static gboolean flash_timeout(gpointer data, gint64 now)
 {
     ObFrame *self = data;
-    GTimeVal now;
 
-    g_get_current_time(&now);
-    if (now.tv_sec > self->flash_end.tv_sec ||
-        (now.tv_sec == self->flash_end.tv_sec &&
-         now.tv_usec >= self->flash_end.tv_usec))
+    if (now >= self->flash_end)
         self->flashing = FALSE;
 
     if (!self->flashing) {
@@ -1699,11 +1695,8 @@ void frame_flash_start(ObFrame *self)
     self->flash_on = self->focused;
 
     if (!self->flashing)
-        self->flash_timer = g_timeout_add_full(G_PRIORITY_DEFAULT,
-                                               600, flash_timeout, self,
-                                               flash_done);
-    g_get_current_time(&self->flash_end);
-    g_time_val_add(&self->flash_end, G_USEC_PER_SEC * 5);
+        self->flash_timer = animate_add(600, flash_timeout, self, flash_done);
+    self->flash_end = animate_time() + G_USEC_PER_SEC * 5;
 
     self->flashing = TRUE;
 }
@@ -1713,26 +1706,17 @@ void frame_flash_stop(ObFrame *self)
     self->flashing = FALSE;
 }
 
-static gulong frame_animate_iconify_time_left(ObFrame *self,
-                                              const GTimeVal *now)
+static gulong frame_animate_iconify_time_left(ObFrame *self, gint64 now)
 {
-    glong sec, usec;
-    sec = self->iconify_animation_end.tv_sec - now->tv_sec;
-    usec = self->iconify_animation_end.tv_usec - now->tv_usec;
-    if (usec < 0) {
-        usec += G_USEC_PER_SEC;
-        sec--;
-    }
     /* no negative values */
-    return MAX(sec * G_USEC_PER_SEC + usec, 0);
+    return MAX(self->iconify_animation_end - now, 0);
 }
 
-static gboolean frame_animate_iconify(gpointer p)
+static gboolean frame_animate_iconify(gpointer p, gint64 now)
 {
     ObFrame *self = p;
     gint x, y, w, h;
     gint iconx, icony, iconw;
-    GTimeVal now;
     gulong time;
     gboolean iconifying;
 
@@ -1753,8 +1737,7 @@ static gboolean frame_animate_iconify(gpointer p)
     iconifying = self->iconify_animation_going > 0;
 
     /* how far do we have left to go ? */
-    g_get_current_time(&now);
-    time = frame_animate_iconify_time_left(self, &now);
+    time = frame_animate_iconify_time_left(self, now);
 
     if ((time > 0 && iconifying) || (time == 0 && !iconifying)) {
         /* start where the frame is supposed to be */
@@ -1787,8 +1770,8 @@ static gboolean frame_animate_iconify(gpointer p)
         h = self->size.top; /* just the titlebar */
     }
 
+    /* this is flushed along with any other animations */
     XMoveResizeWindow(obt_display, self->window, x, y, w, h);
-    XFlush(obt_display);
 
     return time > 0; /* repeat until we're out of time */
 }
@@ -1827,7 +1810,7 @@ void frame_begin_iconify_animation(ObFrame *self, gboolean iconifying)
     gulong time;
     gboolean new_anim = FALSE;
     gboolean set_end = TRUE;
-    GTimeVal now;
+    gint64 now;
 
     /* if there is no titlebar, just don't animate for now
        XXX it would be nice tho.. */
@@ -1835,14 +1818,14 @@ void frame_begin_iconify_animation(ObFrame *self, gboolean iconifying)
         return;
 
     /* get the current time */
-    g_get_current_time(&now);
+    now = animate_time();
 
     /* get how long until the end */
     time = FRAME_ANIMATE_ICONIFY_TIME;
     if (self->iconify_animation_going) {
         if (!!iconifying != (self->iconify_animation_going > 0)) {
             /* animation was already going on in the opposite direction */
-            time = time - frame_animate_iconify_time_left(self, &now);
+            time = time - frame_animate_iconify_time_left(self, now);
         } else
             /* animation was already going in the same direction */
             set_end = FALSE;
@@ -1851,24 +1834,18 @@ void frame_begin_iconify_animation(ObFrame *self, gboolean iconifying)
     self->iconify_animation_going = iconifying ? 1 : -1;
 
     /* set the ending time */
-    if (set_end) {
-        self->iconify_animation_end.tv_sec = now.tv_sec;
-        self->iconify_animation_end.tv_usec = now.tv_usec;
-        g_time_val_add(&self->iconify_animation_end, time);
-    }
+    if (set_end)
+        self->iconify_animation_end = now + time;
 
     if (new_anim) {
         if (self->iconify_animation_timer)
-            g_source_remove(self->iconify_animation_timer);
+            animate_remove(self->iconify_animation_timer);
         self->iconify_animation_timer =
-            g_timeout_add_full(G_PRIORITY_DEFAULT,
-                               FRAME_ANIMATE_ICONIFY_STEP_TIME,
-                               frame_animate_iconify, self,
-                               frame_end_iconify_animation);
-                               
+            animate_add(ANIMATE_FRAME_TIME, frame_animate_iconify, self,
+                        frame_end_iconify_animation);
 
         /* do the first step */
-        frame_animate_iconify(self);
+        frame_animate_iconify(self, now);
 
         /* show it during the animation even if it is not "visible" */
         if (!self->visible)
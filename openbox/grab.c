@@ -33,8 +33,11 @@
 
 #define MASK_LIST_SIZE 8
 
-/*! A list of all possible combinations of keyboard lock masks */
+/*! A list of all distinct combinations of keyboard lock masks */
 static guint mask_list[MASK_LIST_SIZE];
+/*! The number of combinations in the mask_list.  Lock keys which are not
+  mapped to a modifier, or which share one, don't add any combinations */
+static guint mask_list_size = 0;
 static guint kgrabs = 0;
 static guint pgrabs = 0;
 /*! The time at which the last grab was made */
@@ -150,24 +153,43 @@ gint grab_server(gboolean grab)
     return sgrabs;
 }
 
-void grab_startup(gboolean reconfig)
+/*! Fills states with the distinct modifier states made by adding each
+  combination of the lock masks to the given state, and returns how many
+  there are */
+static guint lock_states(guint state, guint states[MASK_LIST_SIZE])
 {
-    guint i = 0;
-    guint num, caps, scroll;
+    guint i, j, n = 0;
+
+    for (i = 0; i < mask_list_size; ++i) {
+        const guint s = state | mask_list[i];
 
-    num = obt_keyboard_modkey_to_modmask(OBT_KEYBOARD_MODKEY_NUMLOCK);
-    caps = obt_keyboard_modkey_to_modmask(OBT_KEYBOARD_MODKEY_CAPSLOCK);
-    scroll = obt_keyboard_modkey_to_modmask(OBT_KEYBOARD_MODKEY_SCROLLLOCK);
+        for (j = 0; j < n && states[j] != s; ++j);
+        if (j == n)
+            states[n++] = s;
+    }
+    return n;
+}
 
-    mask_list[i++] = 0;
-    mask_list[i++] = num;
-    mask_list[i++] = caps;
-    mask_list[i++] = scroll;
-    mask_list[i++] = num | caps;
-    mask_list[i++] = num | scroll;
-    mask_list[i++] = caps | scroll;
-    mask_list[i++] = num | caps | scroll;
-    g_assert(i == MASK_LIST_SIZE);
+void grab_startup(gboolean reconfig)
+{
+    guint locks[3];
+    guint i, j;
+
+    locks[0] = obt_keyboard_modkey_to_modmask(OBT_KEYBOARD_MODKEY_NUMLOCK);
+    locks[1] = obt_keyboard_modkey_to_modmask(OBT_KEYBOARD_MODKEY_CAPSLOCK);
+    locks[2] = obt_keyboard_modkey_to_modmask(OBT_KEYBOARD_MODKEY_SCROLLLOCK);
+
+    /* each bit in i picks one of the locks */
+    mask_list_size = 0;
+    for (i = 0; i < MASK_LIST_SIZE; ++i) {
+        const guint m = (i & 1 ? locks[0] : 0) |
+                        (i & 2 ? locks[1] : 0) |
+                        (i & 4 ? locks[2] : 0);
+
+        for (j = 0; j < mask_list_size && mask_list[j] != m; ++j);
+        if (j == mask_list_size)
+            mask_list[mask_list_size++] = m;
+    }
 
     ic = obt_keyboard_context_new(obt_root(ob_screen), grab_window());
 }
@@ -188,37 +210,46 @@ void grab_button_full(guint button, guint state, Window win, guint mask,
                       gint pointer_mode, ObCursor cur)
 {
     guint i;
+    guint states[MASK_LIST_SIZE], n;
+
+    n = lock_states(state, states);
 
-    /* can get BadAccess from these */
-    obt_display_ignore_errors(TRUE);
-    for (i = 0; i < MASK_LIST_SIZE; ++i)
-        XGrabButton(obt_display, button, state | mask_list[i], win, False,
+    /* can get BadAccess from these, but don't wait around to find out */
+    obt_display_trap_push();
+    for (i = 0; i < n; ++i)
+        XGrabButton(obt_display, button, states[i], win, False,
                     mask, pointer_mode, GrabModeAsync, None, ob_cursor(cur));
-    obt_display_ignore_errors(FALSE);
-    if (obt_display_error_occured)
-        ob_debug("Failed to grab button %d modifiers %d", button, state);
+    obt_display_trap_pop_ignored();
 }
 
 void ungrab_button(guint button, guint state, Window win)
 {
     guint i;
+    guint states[MASK_LIST_SIZE], n;
+
+    n = lock_states(state, states);
+    for (i = 0; i < n; ++i)
+        XUngrabButton(obt_display, button, states[i], win);
+}
 
-    for (i = 0; i < MASK_LIST_SIZE; ++i)
-        XUngrabButton(obt_display, button, state | mask_list[i], win);
+void ungrab_all_buttons(Window win)
+{
+    XUngrabButton(obt_display, AnyButton, AnyModifier, win);
 }
 
 void grab_key(guint keycode, guint state, Window win, gint keyboard_mode)
 {
     guint i;
+    guint states[MASK_LIST_SIZE], n;
+
+    n = lock_states(state, states);
 
-    /* can get BadAccess' from these */
-    obt_display_ignore_errors(TRUE);
-    for (i = 0; i < MASK_LIST_SIZE; ++i)
-        XGrabKey(obt_display, keycode, state | mask_list[i], win, FALSE,
+    /* can get BadAccess' from these, but don't wait around to find out */
+    obt_display_trap_push();
+    for (i = 0; i < n; ++i)
+        XGrabKey(obt_display, keycode, states[i], win, FALSE,
                  GrabModeAsync, keyboard_mode);
-    obt_display_ignore_errors(FALSE);
-    if (obt_display_error_occured)
-        ob_debug("Failed to grab keycode %d modifiers %d", keycode, state);
+    obt_display_trap_pop_ignored();
 }
 
 void ungrab_all_keys(Window win)
@@ -47,6 +47,8 @@ gboolean grab_on_pointer(void);
 void grab_button_full(guint button, guint state, Window win, guint mask,
                       gint pointer_mode, ObCursor cursor);
 void ungrab_button(guint button, guint state, Window win);
+/*! Removes all of the button grabs on the window in a single request */
+void ungrab_all_buttons(Window win);
 
 void grab_key(guint keycode, guint state, Window win, gint keyboard_mode);
 
@@ -323,7 +323,10 @@ void keyboard_rebind(void)
 
 void keyboard_startup(gboolean reconfig)
 {
-    grab_keys(TRUE);
+    /* when reconfiguring, the grabs for the old bindings are still in
+       place, and only need replacing if the bindings changed */
+    if (!reconfig || config_section_changed("keyboard"))
+        grab_keys(TRUE);
     popup = popup_new();
     popup_set_text_align(popup, RR_JUSTIFY_CENTER);
 }
@@ -332,8 +335,10 @@ void keyboard_shutdown(gboolean reconfig)
 {
     if (chain_timer) g_source_remove(chain_timer);
 
-    keyboard_unbind_all();
+    /* leave a chain while the bindings are still there, so the grabs on
+       the root of the bindings are what remains */
     set_curpos(NULL);
+    keyboard_unbind_all();
 
     popup_free(popup);
     popup = NULL;
@@ -0,0 +1,179 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   latency.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox developers
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#include "latency.h"
+#include "debug.h"
+#include "gettext.h"
+#include "obt/paths.h"
+
+#include <errno.h>
+#include <stdio.h>
+
+/* Times are bucketed the way HDR histograms do it.  Below SUB_BUCKETS
+   microseconds each time gets its own bucket, and above that each power of
+   two is split into SUB_BUCKETS buckets, so a bucket is never off by more
+   than 1/SUB_BUCKETS of the time in it. */
+#define SUB_BITS 3
+#define SUB_BUCKETS (1 << SUB_BITS)
+#define NUM_BUCKETS ((64 - SUB_BITS + 1) * SUB_BUCKETS)
+
+struct _ObLatency {
+    gchar   *name;
+    guint64  count;
+    guint64  total;
+    guint64  max;
+    guint32  buckets[NUM_BUCKETS];
+};
+
+/*! All the histograms, by their name */
+static GHashTable *latencies = NULL;
+
+static void latency_free(ObLatency *l)
+{
+    g_free(l->name);
+    g_slice_free(ObLatency, l);
+}
+
+void latency_startup(gboolean reconfig)
+{
+    if (reconfig) return;
+
+    latencies = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+                                      (GDestroyNotify)latency_free);
+}
+
+void latency_shutdown(gboolean reconfig)
+{
+    if (reconfig) return;
+
+    g_hash_table_destroy(latencies);
+    latencies = NULL;
+}
+
+ObLatency* latency_find(const gchar *name)
+{
+    ObLatency *l;
+
+    if (!(l = g_hash_table_lookup(latencies, name))) {
+        l = g_slice_new0(ObLatency);
+        l->name = g_strdup(name);
+        g_hash_table_insert(latencies, l->name, l);
+    }
+    return l;
+}
+
+static guint bucket_index(guint64 v)
+{
+    guint msb;
+
+    if (v < SUB_BUCKETS) return v;
+
+    for (msb = SUB_BITS; msb < 63 && v >> (msb + 1); ++msb);
+    return (msb - SUB_BITS + 1) * SUB_BUCKETS +
+        ((v >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1));
+}
+
+/*! Returns the smallest time which goes in the bucket */
+static guint64 bucket_value(guint i)
+{
+    guint msb;
+
+    if (i < SUB_BUCKETS) return i;
+
+    msb = i / SUB_BUCKETS + SUB_BITS - 1;
+    return (guint64)(SUB_BUCKETS + i % SUB_BUCKETS) << (msb - SUB_BITS);
+}
+
+void latency_add(ObLatency *l, gint64 start)
+{
+    guint64 v = MAX(latency_now() - start, 0);
+
+    ++l->count;
+    l->total += v;
+    l->max = MAX(l->max, v);
+    ++l->buckets[bucket_index(v)];
+}
+
+/*! Returns the time which @percent percent of the times were no longer
+  than */
+static guint64 percentile(const ObLatency *l, guint percent)
+{
+    guint64 want, seen;
+    guint i;
+
+    want = (l->count * percent + 99) / 100;
+    seen = 0;
+    for (i = 0; i < NUM_BUCKETS - 1; ++i) {
+        seen += l->buckets[i];
+        if (seen >= want)
+            return MIN(bucket_value(i + 1) - 1, l->max);
+    }
+    return l->max;
+}
+
+static gint sort_by_total(gconstpointer a, gconstpointer b)
+{
+    const ObLatency *la = a, *lb = b;
+
+    if (la->total != lb->total)
+        return la->total < lb->total ? 1 : -1;
+    return g_strcmp0(la->name, lb->name);
+}
+
+void latency_dump(void)
+{
+    ObtPaths *p;
+    gchar *path;
+    FILE *f;
+    GList *all, *it;
+
+    p = obt_paths_new();
+    path = g_build_filename(obt_paths_cache_home(p), "openbox",
+                            "latency.txt", NULL);
+    obt_paths_unref(p);
+
+    if (!(f = fopen(path, "w"))) {
+        g_message(_("Unable to write the latency histograms to '%s': %s"),
+                  path, g_strerror(errno));
+        g_free(path);
+        return;
+    }
+
+    fprintf(f, "# times are in microseconds\n");
+    fprintf(f, "%-36s %10s %12s %8s %8s %8s %8s %8s\n", "# name", "count",
+            "total", "mean", "p50", "p90", "p99", "max");
+
+    all = g_list_sort(g_hash_table_get_values(latencies), sort_by_total);
+    for (it = all; it; it = g_list_next(it)) {
+        const ObLatency *l = it->data;
+
+        if (!l->count) continue;
+        fprintf(f, "%-36s %10" G_GUINT64_FORMAT " %12" G_GUINT64_FORMAT
+                " %8" G_GUINT64_FORMAT " %8" G_GUINT64_FORMAT
+                " %8" G_GUINT64_FORMAT " %8" G_GUINT64_FORMAT
+                " %8" G_GUINT64_FORMAT "\n",
+                l->name, l->count, l->total, l->total / l->count,
+                percentile(l, 50), percentile(l, 90), percentile(l, 99),
+                l->max);
+    }
+    g_list_free(all);
+    fclose(f);
+
+    ob_debug("Wrote the latency histograms to %s", path);
+    g_free(path);
+}
@@ -0,0 +1,49 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   latency.h for the Openbox window manager
+   Copyright (c) 2026        The Openbox developers
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#ifndef __latency_h
+#define __latency_h
+
+#include <glib.h>
+
+/* Histograms of how long things take, such as handling each type of X event
+   or running each action.  They are always kept, and are written to
+   $XDG_CACHE_HOME/openbox/latency.txt when asked for with
+   "openbox --dump-latency". */
+
+typedef struct _ObLatency ObLatency;
+
+void latency_startup(gboolean reconfig);
+void latency_shutdown(gboolean reconfig);
+
+/*! Returns the histogram with the given name, making it if it doesn't exist
+  yet.  Histograms are kept until openbox exits. */
+ObLatency* latency_find(const gchar *name);
+
+/*! Returns the time to pass to latency_add() once the thing being timed is
+  done */
+#define latency_now() g_get_monotonic_time()
+
+/*! Adds the time since @start, which came from latency_now(), to the
+  histogram */
+void latency_add(ObLatency *l, gint64 start);
+
+/*! Writes all of the histograms out to the latency file */
+void latency_dump(void);
+
+#endif
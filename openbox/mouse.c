@@ -98,14 +98,14 @@ ObFrameContext mouse_button_frame_context(ObFrameContext context,
         return x;
 }
 
-void mouse_grab_for_client(ObClient *client, gboolean grab)
+static void grab_client(ObClient *client)
 {
     gint i;
     GSList *it;
 
     for (i = 0; i < OB_FRAME_NUM_CONTEXTS; ++i)
         for (it = bound_contexts[i]; it; it = g_slist_next(it)) {
-            /* grab/ungrab the button */
+            /* grab the button */
             ObMouseBinding *b = it->data;
             Window win;
             gint mode;
@@ -123,20 +123,35 @@ void mouse_grab_for_client(ObClient *client, gboolean grab)
                                            manufactured in event() */
             } else continue;
 
-            if (grab)
-                grab_button_full(b->button, b->state, win, mask, mode,
-                                 OB_CURSOR_NONE);
-            else
-                ungrab_button(b->button, b->state, win);
+            grab_button_full(b->button, b->state, win, mask, mode,
+                             OB_CURSOR_NONE);
         }
+    client->mouse_grabbed = TRUE;
+}
+
+void mouse_grab_for_client(ObClient *client, gboolean grab)
+{
+    if (grab) {
+        if (!client->mouse_grabbed)
+            grab_client(client);
+    }
+    else if (client->mouse_grabbed) {
+        /* nothing else grabs buttons on these windows, so drop them all at
+           once instead of each binding with each lock modifier */
+        ungrab_all_buttons(client->frame->window);
+        ungrab_all_buttons(client->window);
+        client->mouse_grabbed = FALSE;
+    }
 }
 
 static void grab_all_clients(gboolean grab)
 {
     GList *it;
 
+    /* the hidden windows are grabbed when they are shown */
     for (it = client_list; it; it = g_list_next(it))
-        mouse_grab_for_client(it->data, grab);
+        if (!grab || client_should_show(it->data))
+            mouse_grab_for_client(it->data, grab);
 }
 
 void mouse_unbind_all(void)
@@ -403,11 +418,16 @@ gboolean mouse_bind(const gchar *buttonstr, ObFrameContext context,
 
 void mouse_startup(gboolean reconfig)
 {
+    /* when reconfiguring, the windows still have the grabs for the old
+       bindings, which only need replacing if the bindings changed */
+    if (reconfig && config_section_changed("mouse"))
+        grab_all_clients(FALSE);
     grab_all_clients(TRUE);
 }
 
 void mouse_shutdown(gboolean reconfig)
 {
-    grab_all_clients(FALSE);
+    if (!reconfig)
+        grab_all_clients(FALSE);
     mouse_unbind_all();
 }
@@ -35,6 +35,8 @@ void mouse_unbind_all(void);
 
 gboolean mouse_event(struct _ObClient *client, XEvent *e);
 
+/*! Grabs or ungrabs the mouse bindings on the client's windows.  Grabbing a
+  client which is grabbed already does nothing. */
 void mouse_grab_for_client(struct _ObClient *client, gboolean grab);
 
 ObFrameContext mouse_button_frame_context(ObFrameContext context,
@@ -27,6 +27,8 @@
 #include "resist.h"
 #include "popup.h"
 #include "moveresize.h"
+#include "stacking.h"
+#include "window.h"
 #include "config.h"
 #include "event.h"
 #include "debug.h"
@@ -43,6 +45,19 @@
 /* how far windows move and resize with the keyboard arrows */
 #define KEY_DIST 8
 #define SYNC_TIMEOUTS 4
+/* how thick the outline drawn for clients that can't keep up is */
+#define OUTLINE_WIDTH 2
+/* the time between commits (in milliseconds) when the commit rate is Auto,
+   before anything is known about the client, and the limits on it.  clients
+   which answer faster than the minimum are resized on every motion event */
+#define AUTO_INTERVAL_DEFAULT 16
+#define AUTO_INTERVAL_MIN 4
+#define AUTO_INTERVAL_MAX 100
+/* how long to wait for a client to answer a sync request (in milliseconds)
+   when nothing is known about it, and the limits on it otherwise */
+#define SYNC_TIMEOUT_DEFAULT 2000
+#define SYNC_TIMEOUT_MIN 50
+#define SYNC_TIMEOUT_MAX 2000
 
 gboolean moveresize_in_progress = FALSE;
 ObClient *moveresize_client = NULL;
@@ -67,14 +82,29 @@ static ObDirection key_resize_edge = -1;
 static guint waiting_for_sync;
 #ifdef SYNC
 static guint sync_timer = 0;
+static guint sync_timeout = 0; /* how long sync_timer waits for an answer */
+static gint64 sync_sent_time; /* when the last sync request was sent */
 #endif
+static guint commit_timer = 0;
+static gboolean commit_pending = FALSE;
 
 static ObPopup *popup = NULL;
 
+static struct
+{
+    ObInternalWindow top;
+    ObInternalWindow left;
+    ObInternalWindow right;
+    ObInternalWindow bottom;
+} outline;
+static gboolean outline_visible = FALSE;
+
 static void do_move(gboolean keyboard, gint keydist);
 static void do_resize(void);
+static void do_commit(void);
 static void do_edge_warp(gint x, gint y);
 static void cancel_edge_warp();
+static void outline_hide(void);
 #ifdef SYNC
 static gboolean sync_timeout_func(gpointer data);
 #endif
@@ -87,13 +117,50 @@ static void client_dest(ObClient *client, gpointer data)
         popup->client = NULL;
 }
 
+static void create_outline_window(ObInternalWindow *w)
+{
+    XSetWindowAttributes attr;
+
+    attr.override_redirect = True;
+    w->type = OB_WINDOW_CLASS_INTERNAL;
+    w->window = XCreateWindow(obt_display, obt_root(ob_screen),
+                              0, 0, 1, 1, 0,
+                              RrDepth(ob_rr_inst), InputOutput,
+                              RrVisual(ob_rr_inst), CWOverrideRedirect,
+                              &attr);
+    stacking_add(INTERNAL_AS_WINDOW(w));
+    window_add(&w->window, INTERNAL_AS_WINDOW(w));
+}
+
+static void destroy_outline_window(ObInternalWindow *w)
+{
+    window_remove(w->window);
+    stacking_remove(INTERNAL_AS_WINDOW(w));
+    XDestroyWindow(obt_display, w->window);
+}
+
 void moveresize_startup(gboolean reconfig)
 {
+    gulong pixel;
+
     popup = popup_new();
     popup_set_text_align(popup, RR_JUSTIFY_CENTER);
 
-    if (!reconfig)
+    if (!reconfig) {
         client_add_destroy_notify(client_dest, NULL);
+
+        create_outline_window(&outline.top);
+        create_outline_window(&outline.left);
+        create_outline_window(&outline.right);
+        create_outline_window(&outline.bottom);
+    }
+
+    /* the theme may have changed */
+    pixel = RrColorPixel(ob_rr_theme->frame_focused_border_color);
+    XSetWindowBackground(obt_display, outline.top.window, pixel);
+    XSetWindowBackground(obt_display, outline.left.window, pixel);
+    XSetWindowBackground(obt_display, outline.right.window, pixel);
+    XSetWindowBackground(obt_display, outline.bottom.window, pixel);
 }
 
 void moveresize_shutdown(gboolean reconfig)
@@ -102,12 +169,174 @@ void moveresize_shutdown(gboolean reconfig)
         if (moveresize_in_progress)
             moveresize_end(FALSE);
         client_remove_destroy_notify(client_dest);
+
+        destroy_outline_window(&outline.top);
+        destroy_outline_window(&outline.left);
+        destroy_outline_window(&outline.right);
+        destroy_outline_window(&outline.bottom);
     }
 
     popup_free(popup);
     popup = NULL;
 }
 
+static void outline_show(const Rect *r)
+{
+    gulong ignore_start;
+    const gint w = OUTLINE_WIDTH;
+
+    /* kill enter events cause by this moving */
+    ignore_start = event_start_ignore_all_enters();
+
+    XMoveResizeWindow(obt_display, outline.top.window,
+                      r->x, r->y, MAX(r->width, 1), w);
+    XMoveResizeWindow(obt_display, outline.left.window,
+                      r->x, r->y, w, MAX(r->height, 1));
+    XMoveResizeWindow(obt_display, outline.right.window,
+                      r->x + r->width - w, r->y, w, MAX(r->height, 1));
+    XMoveResizeWindow(obt_display, outline.bottom.window,
+                      r->x, r->y + r->height - w, MAX(r->width, 1), w);
+
+    if (!outline_visible) {
+        XMapWindow(obt_display, outline.top.window);
+        XMapWindow(obt_display, outline.left.window);
+        XMapWindow(obt_display, outline.right.window);
+        XMapWindow(obt_display, outline.bottom.window);
+        outline_visible = TRUE;
+    }
+
+    event_end_ignore_all_enters(ignore_start);
+}
+
+static void outline_hide(void)
+{
+    gulong ignore_start;
+
+    if (!outline_visible) return;
+
+    /* kill enter events cause by this unmapping */
+    ignore_start = event_start_ignore_all_enters();
+
+    XUnmapWindow(obt_display, outline.top.window);
+    XUnmapWindow(obt_display, outline.left.window);
+    XUnmapWindow(obt_display, outline.right.window);
+    XUnmapWindow(obt_display, outline.bottom.window);
+
+    event_end_ignore_all_enters(ignore_start);
+
+    outline_visible = FALSE;
+}
+
+#ifdef SYNC
+static guint sync_latency_bucket(guint ms)
+{
+    guint b;
+
+    for (b = 0; ms > 1 && b < OB_SYNC_LATENCY_BUCKETS - 1; ++b)
+        ms >>= 1;
+    return b;
+}
+
+static void sync_latency_add(ObSyncLatency *l, guint ms)
+{
+    if (l->count == OB_SYNC_LATENCY_SAMPLES)
+        /* forget the oldest sample */
+        --l->buckets[sync_latency_bucket(l->samples[l->next])];
+    else
+        ++l->count;
+
+    l->samples[l->next] = MIN(ms, G_MAXUINT16);
+    ++l->buckets[sync_latency_bucket(l->samples[l->next])];
+    l->next = (l->next + 1) % OB_SYNC_LATENCY_SAMPLES;
+}
+
+/*! Returns the latency in milliseconds that percent of the client's recent
+  sync requests were answered within, or 0 if there are no samples yet */
+static guint sync_latency_percentile(const ObSyncLatency *l, guint percent)
+{
+    guint b, n, want;
+
+    if (!l->count) return 0;
+
+    want = MAX((l->count * percent + 99) / 100, 1);
+    for (b = 0, n = 0; b < OB_SYNC_LATENCY_BUCKETS - 1; ++b) {
+        n += l->buckets[b];
+        if (n >= want) break;
+    }
+    /* the top of the bucket */
+    return (2 << b) - 1;
+}
+
+/*! Returns how long to wait for the client to answer a sync request before
+  giving up on it.  Clients that are usually slow get more time. */
+static guint sync_latency_timeout(const ObSyncLatency *l)
+{
+    guint p90 = sync_latency_percentile(l, 90);
+
+    if (!p90) return SYNC_TIMEOUT_DEFAULT;
+    return CLAMP(p90 * 3, SYNC_TIMEOUT_MIN, SYNC_TIMEOUT_MAX);
+}
+
+static void sync_latency_report(ObClient *c)
+{
+    const ObSyncLatency *l = &c->sync_latency;
+    GString *s;
+    guint b;
+
+    if (!l->count) return;
+
+    s = g_string_new(NULL);
+    for (b = 0; b < OB_SYNC_LATENCY_BUCKETS; ++b)
+        g_string_append_printf(s, " %u", l->buckets[b]);
+    ob_debug("Sync latency for window 0x%x: median %u ms, 90%% %u ms, "
+             "%u timeouts, histogram:%s",
+             c->window, sync_latency_percentile(l, 50),
+             sync_latency_percentile(l, 90), l->timeouts, s->str);
+    g_string_free(s, TRUE);
+}
+#endif
+
+/*! Returns TRUE if the client is not keeping up with the move/resize and
+  should be shown as an outline until it is done */
+static gboolean use_outline(void)
+{
+    if (!config_resize_outline) return FALSE;
+    if (moveresize_client->not_responding) return TRUE;
+    /* moving doesn't make the client redraw anything */
+    if (moving) return FALSE;
+#ifdef SYNC
+    /* sync clients tell us when they are ready for more, until they stop
+       answering */
+    if (config_resize_redraw && obt_display_extension_sync &&
+        moveresize_client->sync_request && moveresize_client->sync_counter)
+        return waiting_for_sync > SYNC_TIMEOUTS;
+#endif
+    return TRUE;
+}
+
+/*! Returns the time in milliseconds to wait between changing the window's
+  geometry, or 0 to do it for every motion event */
+static guint commit_interval(void)
+{
+    if (config_resize_rate > 0)
+        return MAX(1000 / config_resize_rate, 1);
+    else if (config_resize_rate < 0) {
+#ifdef SYNC
+        /* go as fast as the client usually answers sync requests */
+        const ObSyncLatency *l = &moveresize_client->sync_latency;
+        guint median = sync_latency_percentile(l, 50);
+
+        if (!moving && median) {
+            if (median < AUTO_INTERVAL_MIN)
+                return 0;
+            return MIN(median, AUTO_INTERVAL_MAX);
+        }
+#endif
+        return AUTO_INTERVAL_DEFAULT;
+    }
+    return 0;
+}
+
 static void popup_coords(ObClient *c, const gchar *format, gint a, gint b)
 {
     gchar *text;
@@ -267,6 +496,7 @@ void moveresize_start(ObClient *c, gint x, gint y, guint b, guint32 cnr)
 
     moveresize_in_progress = TRUE;
     waiting_for_sync = 0;
+    commit_pending = FALSE;
 
 #ifdef SYNC
     if (config_resize_redraw && !moving && obt_display_extension_sync &&
@@ -314,11 +544,22 @@ void moveresize_end(gboolean cancel)
     ungrab_keyboard();
     ungrab_pointer();
 
+    if (commit_timer) g_source_remove(commit_timer);
+    commit_timer = 0;
+    /* let the last pointer position through, so resistance is applied to
+       it */
+    if (commit_pending && !cancel)
+        do_commit();
+    commit_pending = FALSE;
+    outline_hide();
+
     popup_hide(popup);
     popup->client = NULL;
 
     if (!moving) {
 #ifdef SYNC
+        sync_latency_report(moveresize_client);
+
         /* turn off the alarm */
         if (moveresize_alarm != None) {
             XSyncDestroyAlarm(obt_display, moveresize_alarm);
@@ -380,6 +621,18 @@ static void do_move(gboolean keyboard, gint keydist)
     if (!keyboard) resist = config_resist_edge;
     resist_move_monitors(moveresize_client, resist, &cur_x, &cur_y);
 
+    if (use_outline()) {
+        Rect r;
+
+        RECT_SET(r, cur_x, cur_y, cur_w, cur_h);
+        frame_rect_to_frame(moveresize_client->frame, &r);
+        outline_show(&r);
+        if (config_resize_popup_show == 2) /* == "Always" */
+            popup_coords(moveresize_client, "%d x %d", r.x, r.y);
+        return;
+    }
+
+    outline_hide();
     client_configure(moveresize_client, cur_x, cur_y, cur_w, cur_h,
                      TRUE, FALSE, FALSE);
     if (config_resize_popup_show == 2) /* == "Always" */
@@ -402,7 +655,18 @@ static void do_resize(void)
     h = cur_h;
     client_try_configure(moveresize_client, &x, &y, &w, &h,
                          &lw, &lh, TRUE);
-    if (!(w == moveresize_client->area.width &&
+    if (use_outline()) {
+        Rect r;
+
+        RECT_SET(r, x, y, w, h);
+        frame_rect_to_frame(moveresize_client->frame, &r);
+        outline_show(&r);
+    }
+    else
+        outline_hide();
+
+    if (!outline_visible &&
+        !(w == moveresize_client->area.width &&
           h == moveresize_client->area.height) &&
         /* if waiting_for_sync == 0, then we aren't waiting.
            if it is > SYNC_TIMEOUTS, then we have timed out
@@ -439,9 +703,12 @@ static void do_resize(void)
                        NoEventMask, &ce);
 
             waiting_for_sync = 1;
+            sync_sent_time = g_get_monotonic_time();
 
             if (sync_timer) g_source_remove(sync_timer);
-            sync_timer = g_timeout_add(2000, sync_timeout_func, NULL);
+            sync_timeout =
+                sync_latency_timeout(&moveresize_client->sync_latency);
+            sync_timer = g_timeout_add(sync_timeout, sync_timeout_func, NULL);
         }
 #endif
 
@@ -460,9 +727,53 @@ static void do_resize(void)
         popup_coords(moveresize_client, "%d x %d", lw, lh);
 }
 
+static void do_commit(void)
+{
+    commit_pending = FALSE;
+    if (moving)
+        do_move(FALSE, 0);
+    else
+        do_resize();
+}
+
+static gboolean commit_timeout_func(gpointer data)
+{
+    commit_timer = 0;
+    if (commit_pending) {
+        do_commit();
+        /* keep pacing for as long as the pointer keeps moving */
+        commit_timer = g_timeout_add(commit_interval(),
+                                     commit_timeout_func, NULL);
+    }
+    return FALSE; /* don't repeat */
+}
+
+/*! Moves or resizes the window to the latest pointer position, or remembers
+  to do it later if the window was changed too recently */
+static void commit(void)
+{
+    guint interval = commit_interval();
+
+    if (!interval)
+        do_commit();
+    else if (commit_timer)
+        commit_pending = TRUE;
+    else {
+        do_commit();
+        commit_timer = g_timeout_add(interval, commit_timeout_func, NULL);
+    }
+}
+
 #ifdef SYNC
 static gboolean sync_timeout_func(gpointer data)
 {
+    /* count it as taking as long as we waited, so the next timeout will be
+       longer if this keeps happening */
+    if (waiting_for_sync == 1) {
+        sync_latency_add(&moveresize_client->sync_latency, sync_timeout);
+        ++moveresize_client->sync_latency.timeouts;
+    }
+
     ++waiting_for_sync; /* we timed out waiting for our sync... */
     do_resize(); /* ...so let any pending resizes through */
 
@@ -953,7 +1264,7 @@ gboolean moveresize_event(XEvent *e)
         if (moving) {
             cur_x = start_cx + e->xmotion.x_root - start_x;
             cur_y = start_cy + e->xmotion.y_root - start_y;
-            do_move(FALSE, 0);
+            commit();
             do_edge_warp(e->xmotion.x_root, e->xmotion.y_root);
         } else {
             gint dw, dh;
@@ -1063,7 +1374,7 @@ gboolean moveresize_event(XEvent *e)
                 cur_y -= dh;
             }
 
-            do_resize();
+            commit();
         }
         used = TRUE;
     } else if (e->type == KeyPress) {
@@ -1092,8 +1403,11 @@ gboolean moveresize_event(XEvent *e)
 #ifdef SYNC
     else if (e->type == obt_display_extension_sync_basep + XSyncAlarmNotify)
     {
+        if (waiting_for_sync == 1)
+            sync_latency_add(&moveresize_client->sync_latency,
+                             (g_get_monotonic_time() - sync_sent_time) / 1000);
         waiting_for_sync = 0; /* we got our sync... */
-        do_resize(); /* ...so try resize if there is more change pending */
+        do_commit(); /* ...so try resize if there is more change pending */
         used = TRUE;
     }
 #endif
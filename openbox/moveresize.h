@@ -27,6 +27,31 @@
 
 struct _ObClient;
 
+#ifdef SYNC
+/*! The number of recent sync requests remembered for each client */
+#define OB_SYNC_LATENCY_SAMPLES 32
+/*! The number of power-of-two millisecond buckets sync latencies are counted
+  in, the last one holding everything longer */
+#define OB_SYNC_LATENCY_BUCKETS 12
+
+typedef struct _ObSyncLatency ObSyncLatency;
+
+/*! A rolling histogram of how long a client takes to answer
+  _NET_WM_SYNC_REQUEST messages while it is being resized */
+struct _ObSyncLatency {
+    /*! The most recent latencies in milliseconds, used as a ring */
+    guint16 samples[OB_SYNC_LATENCY_SAMPLES];
+    /*! Where the next sample goes in the ring */
+    guint next;
+    /*! How many samples are in the ring */
+    guint count;
+    /*! How many of the samples fall in each bucket */
+    guint8 buckets[OB_SYNC_LATENCY_BUCKETS];
+    /*! How many sync requests were not answered before the timeout */
+    guint timeouts;
+};
+#endif
+
 typedef enum {
     OB_RESIZE_POS_CENTER,
     OB_RESIZE_POS_TOP,
@@ -34,6 +34,7 @@
 #include "moveresize.h"
 #include "frame.h"
 #include "framerender.h"
+#include "animate.h"
 #include "keyboard.h"
 #include "mouse.h"
 #include "menuframe.h"
@@ -41,6 +42,9 @@
 #include "group.h"
 #include "config.h"
 #include "ping.h"
+#include "publish.h"
+#include "recorder.h"
+#include "latency.h"
 #include "prompt.h"
 #include "gettext.h"
 #include "obrender/render.h"
@@ -154,7 +158,10 @@ gint main(gint argc, gchar **argv)
     if (remote_control) {
         /* Send client message telling the OB process to:
          * remote_control = 1 -> reconfigure
-         * remote_control = 2 -> restart */
+         * remote_control = 2 -> restart
+         * remote_control = 3 -> exit
+         * remote_control = 4 -> write out the flight recorder
+         * remote_control = 5 -> write out the latency histograms */
         OBT_PROP_MSG(ob_screen, obt_root(ob_screen),
                      OB_CONTROL, remote_control, 0, 0, 0, 0);
         obt_display_close();
@@ -226,6 +233,7 @@ gint main(gint argc, gchar **argv)
         do {
             gchar *xml_error_string = NULL;
             ObPrompt *xmlprompt = NULL;
+            gboolean theme_changed;
 
             if (reconfigure) obt_keyboard_reload();
 
@@ -247,12 +255,14 @@ gint main(gint argc, gchar **argv)
                     obt_xml_load_config_file(i, "openbox", "rc.xml",
                                              "openbox_config"))
                 {
+                    config_compare_sections(obt_xml_root(i));
                     obt_xml_tree_from_root(i);
                     obt_xml_close(i);
                 }
                 else {
                     g_message(_("Unable to find a valid config file, using some simple defaults"));
                     config_file = NULL;
+                    config_compare_sections(NULL);
                 }
 
                 if (config_file) {
@@ -277,8 +287,12 @@ gint main(gint argc, gchar **argv)
                 obt_xml_instance_unref(i);
             }
 
-            /* load the theme specified in the rc file */
-            {
+            /* load the theme specified in the rc file, unless the same one is
+               loaded already */
+            theme_changed = !reconfigure ||
+                config_section_changed("theme") ||
+                RrThemeChanged(ob_rr_theme);
+            if (theme_changed) {
                 RrTheme *theme;
                 if ((theme = RrThemeNew(ob_rr_inst, config_theme, TRUE,
                                         config_font_activewindow,
@@ -298,7 +312,7 @@ gint main(gint argc, gchar **argv)
                               ob_rr_theme->name);
             }
 
-            if (reconfigure) {
+            if (reconfigure && theme_changed) {
                 GList *it;
 
                 /* update all existing windows for the new theme */
@@ -307,6 +321,9 @@ gint main(gint argc, gchar **argv)
                     frame_adjust_theme(c->frame);
                 }
             }
+            recorder_startup(reconfigure);
+            latency_startup(reconfigure);
+            publish_startup(reconfigure);
             event_startup(reconfigure);
             /* focus_backup is used for stacking, so this needs to come before
                anything that calls stacking_add */
@@ -347,10 +364,12 @@ gint main(gint argc, gchar **argv)
                 {
                     client_focus(WINDOW_AS_CLIENT(w));
                 }
-            } else {
+            } else if (theme_changed) {
                 GList *it;
 
-                /* redecorate all existing windows */
+                /* redecorate all existing windows.  this is only needed when
+                   the theme or its settings changed, as nothing else in the
+                   config changes the decorations or their sizes */
                 for (it = client_list; it; it = g_list_next(it)) {
                     ObClient *c = it->data;
 
@@ -409,7 +428,11 @@ gint main(gint argc, gchar **argv)
             focus_shutdown(reconfigure);
             window_shutdown(reconfigure);
             sn_shutdown(reconfigure);
+            animate_shutdown(reconfigure);
             event_shutdown(reconfigure);
+            publish_shutdown(reconfigure);
+            latency_shutdown(reconfigure);
+            recorder_shutdown(reconfigure);
             config_shutdown();
             actions_shutdown(reconfigure);
         } while (reconfigure);
@@ -420,6 +443,7 @@ gint main(gint argc, gchar **argv)
     RrThemeFree(ob_rr_theme);
     RrImageCacheUnref(ob_rr_icons);
     RrInstanceFree(ob_rr_inst);
+    config_forget_sections();
 
     session_shutdown(being_replaced);
 
@@ -543,6 +567,8 @@ static void print_help(void)
     g_print(_("  --reconfigure       Reload Openbox's configuration\n"));
     g_print(_("  --restart           Restart Openbox\n"));
     g_print(_("  --exit              Exit Openbox\n"));
+    g_print(_("  --dump-recorder     Write out the flight recorder\n"));
+    g_print(_("  --dump-latency      Write out event handling times\n"));
     g_print(_("\nDebugging options:\n"));
     g_print(_("  --sync              Run in synchronous mode\n"));
     g_print(_("  --startup CMD       Run CMD after starting\n"));
@@ -665,6 +691,12 @@ static void parse_args(gint *argc, gchar **argv)
         else if (!strcmp(argv[i], "--exit")) {
             remote_control = 3;
         }
+        else if (!strcmp(argv[i], "--dump-recorder")) {
+            remote_control = 4;
+        }
+        else if (!strcmp(argv[i], "--dump-latency")) {
+            remote_control = 5;
+        }
         else if (!strcmp(argv[i], "--config-file")) {
             if (i == *argc - 1) /* no args left */
                 g_printerr(_("%s requires an argument\n"), "--config-file");
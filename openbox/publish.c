@@ -0,0 +1,85 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   publish.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox developers
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#include "publish.h"
+#include "debug.h"
+
+/*! The functions for the properties which are out of date, in the order
+  they were marked */
+static GSList *pending = NULL;
+static guint idle_id = 0;
+static guint suppressed = 0;
+
+static gboolean flush_idle(gpointer data)
+{
+    idle_id = 0;
+    publish_flush();
+    return FALSE; /* don't repeat */
+}
+
+void publish_startup(gboolean reconfig)
+{
+    if (!reconfig)
+        suppressed = 0;
+}
+
+void publish_shutdown(gboolean reconfig)
+{
+    publish_flush();
+
+    if (!reconfig)
+        ob_debug("Saved %u writes of root window properties", suppressed);
+}
+
+void publish_later(ObPublishFunc func)
+{
+    if (g_slist_find(pending, (gpointer)func)) {
+        ++suppressed;
+        return;
+    }
+
+    pending = g_slist_append(pending, (gpointer)func);
+
+    /* this has the same priority as the X events, so it runs once all the
+       events that are waiting now have been handled */
+    if (!idle_id)
+        idle_id = g_idle_add_full(G_PRIORITY_DEFAULT, flush_idle,
+                                  NULL, NULL);
+}
+
+void publish_flush(void)
+{
+    if (idle_id) {
+        g_source_remove(idle_id);
+        idle_id = 0;
+    }
+
+    /* writing one property can mark another one, so keep going until they
+       are all done */
+    while (pending) {
+        ObPublishFunc func = (ObPublishFunc)pending->data;
+
+        pending = g_slist_delete_link(pending, pending);
+        func();
+    }
+}
+
+guint publish_suppressed(void)
+{
+    return suppressed;
+}
@@ -0,0 +1,41 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   publish.h for the Openbox window manager
+   Copyright (c) 2026        The Openbox developers
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#ifndef __publish_h
+#define __publish_h
+
+#include <glib.h>
+
+/*! A function which writes a property on the root window */
+typedef void (*ObPublishFunc)(void);
+
+void publish_startup(gboolean reconfig);
+void publish_shutdown(gboolean reconfig);
+
+/*! Marks a root window property as out of date.  The function which writes
+  it is called once, after the events currently waiting have been handled,
+  however many times the property is marked before then. */
+void publish_later(ObPublishFunc func);
+
+/*! Writes all of the out of date properties now */
+void publish_flush(void);
+
+/*! Returns how many writes were saved by waiting to write the properties */
+guint publish_suppressed(void);
+
+#endif
@@ -0,0 +1,160 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   recorder.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox developers
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#include "recorder.h"
+#include "debug.h"
+#include "gettext.h"
+#include "obt/paths.h"
+#include "obt/signal.h"
+
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* this must be a power of two */
+#define RECORDER_SIZE 4096
+
+static ObRecord  records[RECORDER_SIZE];
+/*! The sequence number for the next record */
+static guint32   seq = 0;
+/*! The timestamp of the last X event */
+static guint32   curtime = 0;
+/*! Where to write the flight recorder, figured out ahead of time since it is
+  written from inside the crash handler */
+static gchar    *dump_path = NULL;
+
+static void crash_dump(gint sig, gpointer data);
+
+void recorder_startup(gboolean reconfig)
+{
+    ObtPaths *p;
+    gchar *dir;
+
+    if (reconfig) return;
+
+    p = obt_paths_new();
+    dir = g_build_filename(obt_paths_cache_home(p), "openbox", NULL);
+    if (!obt_paths_mkdir_path(dir, 0777))
+        g_message(_("Unable to make directory '%s': %s"),
+                  dir, g_strerror(errno));
+    else
+        dump_path = g_build_filename(dir, "recorder.bin", NULL);
+    obt_paths_unref(p);
+    g_free(dir);
+
+    obt_signal_add_crash_handler(crash_dump, NULL);
+}
+
+void recorder_shutdown(gboolean reconfig)
+{
+    if (reconfig) return;
+
+    obt_signal_remove_crash_handler(crash_dump);
+    g_free(dump_path);
+    dump_path = NULL;
+}
+
+void recorder_event(gint type, guint32 window, guint32 serial, guint32 time)
+{
+    if (time) curtime = time;
+    recorder_record(OB_RECORD_EVENT, type, window, serial, 0, 0, 0);
+}
+
+void recorder_record(ObRecordKind kind, guint16 type, guint32 window,
+                     guint32 arg0, guint32 arg1, guint32 arg2, guint32 arg3)
+{
+    ObRecord *r = &records[seq & (RECORDER_SIZE - 1)];
+
+    r->seq = seq++;
+    r->time = curtime;
+    r->window = window;
+    r->arg[0] = arg0;
+    r->arg[1] = arg1;
+    r->arg[2] = arg2;
+    r->arg[3] = arg3;
+    r->kind = kind;
+    r->type = type;
+}
+
+/*! Writes all of the data to the file, using only functions which are safe
+  to use in a signal handler */
+static gboolean write_all(gint fd, gconstpointer data, gsize size)
+{
+    const gchar *p = data;
+
+    while (size > 0) {
+        gssize n = write(fd, p, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return FALSE;
+        }
+        p += n;
+        size -= n;
+    }
+    return TRUE;
+}
+
+static gboolean dump_to(const gchar *path)
+{
+    ObRecorderHeader h;
+    guint32 count, first;
+    gint fd;
+    gboolean ok;
+
+    if ((fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0600)) < 0)
+        return FALSE;
+
+    count = MIN(seq, RECORDER_SIZE);
+    first = (seq - count) & (RECORDER_SIZE - 1);
+
+    memcpy(h.magic, OB_RECORDER_MAGIC, sizeof(h.magic));
+    h.version = OB_RECORDER_VERSION;
+    h.record_size = sizeof(ObRecord);
+    h.count = count;
+
+    /* the records from the oldest to the end of the array, and then any
+       which wrapped around to the start of it */
+    ok = write_all(fd, &h, sizeof(h));
+    if (ok)
+        ok = write_all(fd, &records[first],
+                       MIN(count, RECORDER_SIZE - first) * sizeof(ObRecord));
+    if (ok && first + count > RECORDER_SIZE)
+        ok = write_all(fd, records,
+                       (first + count - RECORDER_SIZE) * sizeof(ObRecord));
+
+    close(fd);
+    return ok;
+}
+
+void recorder_dump(void)
+{
+    if (!dump_path) return;
+
+    if (dump_to(dump_path))
+        ob_debug("Wrote the flight recorder to %s", dump_path);
+    else
+        g_message(_("Unable to write the flight recorder to '%s': %s"),
+                  dump_path, g_strerror(errno));
+}
+
+static void crash_dump(gint sig, gpointer data)
+{
+    if (dump_path)
+        dump_to(dump_path);
+}
@@ -0,0 +1,81 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   recorder.h for the Openbox window manager
+   Copyright (c) 2026        The Openbox developers
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+#ifndef __recorder_h
+#define __recorder_h
+
+#include <glib.h>
+
+/* The flight recorder always keeps the last few thousand X events and window
+   management decisions in memory, so they can be looked at after something
+   goes wrong.  It is written to $XDG_CACHE_HOME/openbox/recorder.bin when
+   asked for with "openbox --dump-recorder", or when openbox crashes, and can
+   be read with the obrecorder tool. */
+
+#define OB_RECORDER_MAGIC   "OBFR"
+#define OB_RECORDER_VERSION 1
+
+typedef enum {
+    OB_RECORD_EVENT,     /*!< An X event was handled.
+                              type = the event type, arg[0] = its serial */
+    OB_RECORD_FOCUS,     /*!< Focus was given to a client.
+                              window = the client, or 0 for no client,
+                              arg[0] = the client which had focus */
+    OB_RECORD_RESTACK,   /*!< Windows were moved in the stacking order.
+                              window = the first window moved,
+                              arg[0] = how many were moved, arg[1] = the
+                              window they were put above, or 0 for the
+                              bottom */
+    OB_RECORD_CONFIGURE  /*!< A client was moved or resized.
+                              window = the client, arg[0-3] = its x, y,
+                              width and height, type = 1 if the user did it */
+} ObRecordKind;
+
+/*! One record in the flight recorder, as it is written to the dump file */
+typedef struct _ObRecord {
+    guint32 seq;     /*!< Counts up for each record */
+    guint32 time;    /*!< The timestamp of the last X event */
+    guint32 window;  /*!< The window the record is about */
+    guint32 arg[4];  /*!< Depends on the kind */
+    guint16 kind;    /*!< An ObRecordKind */
+    guint16 type;    /*!< Depends on the kind */
+} ObRecord;
+
+/*! The start of the dump file, which is followed by the records from the
+  oldest to the newest */
+typedef struct _ObRecorderHeader {
+    gchar   magic[4];    /*!< OB_RECORDER_MAGIC */
+    guint32 version;     /*!< OB_RECORDER_VERSION */
+    guint32 record_size; /*!< sizeof(ObRecord) */
+    guint32 count;       /*!< The number of records in the file */
+} ObRecorderHeader;
+
+void recorder_startup(gboolean reconfig);
+void recorder_shutdown(gboolean reconfig);
+
+/*! Records an X event which is about to be handled */
+void recorder_event(gint type, guint32 window, guint32 serial, guint32 time);
+
+/*! Records a window management decision */
+void recorder_record(ObRecordKind kind, guint16 type, guint32 window,
+                     guint32 arg0, guint32 arg1, guint32 arg2, guint32 arg3);
+
+/*! Writes the flight recorder out to its dump file */
+void recorder_dump(void);
+
+#endif
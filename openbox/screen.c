@@ -32,6 +32,7 @@
 #include "focus.h"
 #include "focus_cycle.h"
 #include "popup.h"
+#include "publish.h"
 #include "version.h"
 #include "obrender/render.h"
 #include "gettext.h"
@@ -531,6 +532,7 @@ void screen_set_num_desktops(guint num)
     /* move windows on desktops that will no longer exist!
        make a copy of the list cuz we're changing it */
     stacking_copy = g_list_copy(stacking_list);
+    stacking_begin();
     for (it = g_list_last(stacking_copy); it; it = g_list_previous(it)) {
         if (WINDOW_IS_CLIENT(it->data)) {
             ObClient *c = it->data;
@@ -544,6 +546,7 @@ void screen_set_num_desktops(guint num)
                 stacking_raise(CLIENT_AS_WINDOW(c));
         }
     }
+    stacking_commit();
     g_list_free(stacking_copy);
 
     /* change our struts/area to match (after moving windows) */
@@ -608,7 +611,7 @@ static gboolean last_desktop_func(gpointer data)
 
 void screen_set_desktop(guint num, gboolean dofocus)
 {
-    GList *it;
+    GList *it, *show, *hide;
     guint previous;
     gulong ignore_start;
 
@@ -700,36 +703,39 @@ void screen_set_desktop(guint num, gboolean dofocus)
     if (moveresize_client)
         client_set_desktop(moveresize_client, num, TRUE, FALSE);
 
-    /* show windows before hiding the rest to lessen the enter/leave events */
-
-    /* show windows from top to bottom */
-    for (it = stacking_list; it; it = g_list_next(it)) {
-        if (WINDOW_IS_CLIENT(it->data)) {
-            ObClient *c = it->data;
-            client_show(c);
-        }
-    }
+    /* only the windows on the old and new desktops, and the ones on all the
+       desktops, can change visibility.  they are shown from the top down
+       and hidden from the bottom up */
+    show = client_desktop_list(num);
+    show = g_list_concat(show, client_desktop_list(DESKTOP_ALL));
+    show = stacking_sort(show, TRUE);
+    hide = stacking_sort(client_desktop_list(previous), FALSE);
+
+    /* show windows before hiding the rest to lessen the enter/leave events.
+       hold the server grab across all of them instead of syncing with the
+       server for each window */
+    grab_server(TRUE);
+    for (it = show; it; it = g_list_next(it))
+        client_show(it->data);
+    grab_server(FALSE);
 
     if (dofocus) screen_fallback_focus();
 
-    /* hide windows from bottom to top */
-    for (it = g_list_last(stacking_list); it; it = g_list_previous(it)) {
-        if (WINDOW_IS_CLIENT(it->data)) {
-            ObClient *c = it->data;
-            if (client_hide(c)) {
-                if (c == focus_client) {
-                    /* c was focused and we didn't do fallback clearly so make
-                       sure openbox doesnt still consider the window focused.
-                       this happens when using NextWindow with allDesktops,
-                       since it doesnt want to move focus on desktop change,
-                       but the focus is not going to stay with the current
-                       window, which has now disappeared.
-                       only do this if the client was actually hidden,
-                       otherwise it can keep focus. */
-                    focus_set_client(NULL);
-                }
-            }
-        }
+    for (it = hide; it; it = g_list_next(it))
+        client_hide(it->data);
+
+    g_list_free(show);
+    g_list_free(hide);
+
+    if (focus_client && !client_should_show(focus_client)) {
+        /* the focused window was hidden and we didn't do fallback clearly so
+           make sure openbox doesnt still consider the window focused.
+           this happens when using NextWindow with allDesktops, since it
+           doesnt want to move focus on desktop change, but the focus is not
+           going to stay with the current window, which has now disappeared.
+           only do this if the client was actually hidden, otherwise it can
+           keep focus. */
+        focus_set_client(NULL);
     }
 
     focus_cycle_addremove(NULL, TRUE);
@@ -792,6 +798,7 @@ void screen_remove_desktop(gboolean current)
 
     /* make a copy of the list cuz we're changing it */
     stacking_copy = g_list_copy(stacking_list);
+    stacking_begin();
     for (it = g_list_last(stacking_copy); it; it = g_list_previous(it)) {
         if (WINDOW_IS_CLIENT(it->data)) {
             ObClient *c = it->data;
@@ -815,6 +822,7 @@ void screen_remove_desktop(gboolean current)
             }
         }
     }
+    stacking_commit();
     g_list_free(stacking_copy);
 
     /* fallback focus like we're changing desktops */
@@ -1320,12 +1328,12 @@ void screen_install_colormap(ObClient *client, gboolean install)
         else
             XUninstallColormap(obt_display, RrColormap(ob_rr_inst));
     } else {
-        obt_display_ignore_errors(TRUE);
+        obt_display_trap_push();
         if (install)
             XInstallColormap(obt_display, client->colormap);
         else
             XUninstallColormap(obt_display, client->colormap);
-        obt_display_ignore_errors(FALSE);
+        obt_display_trap_pop_ignored();
     }
 }
 
@@ -1415,10 +1423,31 @@ static void get_xinerama_screens(Rect **xin_areas, guint *nxin)
              (*xin_areas)[i].width, (*xin_areas)[i].height);
 }
 
-void screen_update_areas(void)
+static void publish_workarea(void)
 {
     guint i;
     gulong *dims;
+
+    dims = g_new(gulong, 4 * screen_num_desktops);
+    for (i = 0; i < screen_num_desktops; ++i) {
+        Rect *area = screen_area(i, SCREEN_AREA_ALL_MONITORS, NULL);
+        dims[i*4+0] = area->x;
+        dims[i*4+1] = area->y;
+        dims[i*4+2] = area->width;
+        dims[i*4+3] = area->height;
+        g_slice_free(Rect, area);
+    }
+
+    /* set the legacy workarea hint to the union of all the monitors */
+    OBT_PROP_SETA32(obt_root(ob_screen), NET_WORKAREA, CARDINAL,
+                    dims, 4 * screen_num_desktops);
+
+    g_free(dims);
+}
+
+void screen_update_areas(void)
+{
+    guint i;
     GList *it, *onscreen;
 
     /* collect the clients that are on screen */
@@ -1485,25 +1514,11 @@ void screen_update_areas(void)
     VALIDATE_STRUTS(struts_bottom, bottom,
                     monitor_area[screen_num_monitors].height / 2);
 
-    dims = g_new(gulong, 4 * screen_num_desktops);
-    for (i = 0; i < screen_num_desktops; ++i) {
-        Rect *area = screen_area(i, SCREEN_AREA_ALL_MONITORS, NULL);
-        dims[i*4+0] = area->x;
-        dims[i*4+1] = area->y;
-        dims[i*4+2] = area->width;
-        dims[i*4+3] = area->height;
-        g_slice_free(Rect, area);
-    }
-
-    /* set the legacy workarea hint to the union of all the monitors */
-    OBT_PROP_SETA32(obt_root(ob_screen), NET_WORKAREA, CARDINAL,
-                    dims, 4 * screen_num_desktops);
+    publish_later(publish_workarea);
 
     /* the area has changed, adjust all the windows if they need it */
     for (it = onscreen; it; it = g_list_next(it))
         client_reconfigure(it->data, FALSE);
-
-    g_free(dims);
 }
 
 #if 0
@@ -28,6 +28,8 @@
 #include "debug.h"
 #include "dock.h"
 #include "config.h"
+#include "publish.h"
+#include "recorder.h"
 #include "obt/prop.h"
 
 GList  *stacking_list = NULL;
@@ -36,8 +38,142 @@ GList  *stacking_list_tail = NULL;
   to freeze the on-screen stacking order while a window is being temporarily
   raised during focus cycling */
 static gboolean pause_changes = FALSE;
+/*! The nesting depth of stacking transactions */
+static guint transaction = 0;
+/*! Maps each ObWindow to its position in the stacking_list (plus one) when
+  the outermost transaction began */
+static GHashTable *transaction_order = NULL;
+/*! If the stacking_list was changed during the current transaction */
+static gboolean transaction_changed = FALSE;
+/*! Maps each ObWindow in the stacking_list to its link in the list */
+static GHashTable *stacking_links = NULL;
+/*! The highest link in the stacking_list for each layer, or NULL when the
+  layer is empty */
+static GList *layer_top[OB_NUM_STACKING_LAYERS];
+/*! Maps each ObWindow in the stacking_list to a number which is smaller for
+  higher windows, so that windows can be put in stacking order without
+  walking the stacking_list */
+static GHashTable *stacking_keys = NULL;
+/*! The number of windows in the stacking_list */
+static guint stacking_length = 0;
+
+static GList* find_link(ObWindow *win)
+{
+    return stacking_links ? g_hash_table_lookup(stacking_links, win) : NULL;
+}
 
-void stacking_set_list(void)
+static guint window_key(ObWindow *win)
+{
+    return GPOINTER_TO_UINT(g_hash_table_lookup(stacking_keys, win));
+}
+
+/*! Spreads the keys out evenly over the whole stacking_list, when there is
+  no room left for a key between two windows */
+static void spread_keys(void)
+{
+    GList *it;
+    guint i, step;
+
+    step = G_MAXUINT / (stacking_length + 1);
+    for (i = 1, it = stacking_list; it; ++i, it = g_list_next(it))
+        g_hash_table_insert(stacking_keys, it->data,
+                            GUINT_TO_POINTER(i * step));
+}
+
+/*! Returns the highest link in a layer below the given one, or NULL if all
+  of the lower layers are empty */
+static GList* below_layer(ObStackingLayer layer)
+{
+    gint i;
+
+    for (i = (gint)layer - 1; i >= 0; --i)
+        if (layer_top[i]) return layer_top[i];
+    return NULL;
+}
+
+/*! Inserts the window into the stacking_list directly above the before link,
+  or at the bottom if before is NULL */
+static void link_window(ObWindow *win, GList *before)
+{
+    GList *link;
+    ObStackingLayer l;
+    guint above, below;
+
+    g_assert(find_link(win) == NULL);
+
+    link = g_list_alloc();
+    link->data = win;
+    link->next = before;
+    link->prev = before ? before->prev : stacking_list_tail;
+    if (link->prev) link->prev->next = link;
+    else stacking_list = link;
+    if (before) before->prev = link;
+    else stacking_list_tail = link;
+
+    l = window_layer(win);
+    if (!link->prev || window_layer(link->prev->data) != l)
+        layer_top[l] = link;
+
+    if (!stacking_links) {
+        stacking_links = g_hash_table_new(g_direct_hash, g_direct_equal);
+        stacking_keys = g_hash_table_new(g_direct_hash, g_direct_equal);
+    }
+    g_hash_table_insert(stacking_links, win, link);
+    ++stacking_length;
+
+    /* give it a key between the windows above and below it */
+    above = link->prev ? window_key(link->prev->data) : 0;
+    below = before ? window_key(before->data) : G_MAXUINT;
+    if (below - above >= 2)
+        g_hash_table_insert(stacking_keys, win,
+                            GUINT_TO_POINTER(above + (below - above) / 2));
+    else
+        spread_keys();
+}
+
+/*! Takes the window out of the stacking_list, if it is in there */
+static void unlink_window(ObWindow *win)
+{
+    GList *link, *next;
+    gint i;
+
+    if (!(link = find_link(win))) return;
+
+    /* the window's layer may have changed already, so look for it */
+    next = g_list_next(link);
+    for (i = 0; i < OB_NUM_STACKING_LAYERS; ++i)
+        if (layer_top[i] == link) {
+            if (next && window_layer(next->data) == (ObStackingLayer)i)
+                layer_top[i] = next;
+            else
+                layer_top[i] = NULL;
+            break;
+        }
+
+    if (link == stacking_list_tail)
+        stacking_list_tail = g_list_previous(link);
+    stacking_list = g_list_delete_link(stacking_list, link);
+    g_hash_table_remove(stacking_links, win);
+    g_hash_table_remove(stacking_keys, win);
+    --stacking_length;
+}
+
+static gint compare_keys(gconstpointer a, gconstpointer b, gpointer top_first)
+{
+    guint ka = window_key((ObWindow*)a), kb = window_key((ObWindow*)b);
+    gint c = (ka > kb) - (ka < kb);
+
+    return GPOINTER_TO_INT(top_first) ? c : -c;
+}
+
+GList* stacking_sort(GList *wins, gboolean top_first)
+{
+    if (!stacking_keys) return wins;
+    return g_list_sort_with_data(wins, compare_keys,
+                                 GINT_TO_POINTER(top_first));
+}
+
+static void publish_stacking_list(void)
 {
     Window *windows = NULL;
     GList *it;
@@ -51,8 +187,8 @@ void stacking_set_list(void)
     /* create an array of the window ids (from bottom to top,
        reverse order!) */
     if (stacking_list) {
-        windows = g_new(Window, g_list_length(stacking_list));
-        for (it = g_list_last(stacking_list); it; it = g_list_previous(it)) {
+        windows = g_new(Window, stacking_length);
+        for (it = stacking_list_tail; it; it = g_list_previous(it)) {
             if (WINDOW_IS_CLIENT(it->data))
                 windows[i++] = WINDOW_AS_CLIENT(it->data)->window;
         }
@@ -64,12 +200,125 @@ void stacking_set_list(void)
     g_free(windows);
 }
 
-static void do_restack(GList *wins, GList *before)
+void stacking_set_list(void)
 {
-    GList *it;
+    publish_later(publish_stacking_list);
+}
+
+/*! Restacks the windows which have moved since the transaction began.  The
+  longest run of windows which kept their relative order stays where it is,
+  and every other window is placed directly below its new neighbour above it,
+  with one XRestackWindows for each group of adjacent moved windows. */
+static void restack_changed(void)
+{
+    ObWindow **wins;
     Window *win;
+    gint *old;
+    guint *tails, *prev;
+    gboolean *keep;
+    GList *it;
+    guint n, i, j, k, len;
+
+    n = stacking_length;
+    if (n == 0) return;
+
+    wins = g_new(ObWindow*, n);
+    old = g_new(gint, n);
+    for (i = 0, it = stacking_list; it; ++i, it = g_list_next(it)) {
+        wins[i] = it->data;
+        /* the positions are stored off by one so that NULL is not found */
+        old[i] = GPOINTER_TO_INT(g_hash_table_lookup(transaction_order,
+                                                     wins[i])) - 1;
+    }
+
+    /* find the longest increasing run of old positions in the new order */
+    tails = g_new(guint, n);
+    prev = g_new(guint, n);
+    len = 0;
+    for (i = 0; i < n; ++i) {
+        guint lo = 0, hi = len;
+
+        if (old[i] < 0) continue;
+
+        while (lo < hi) {
+            const guint mid = (lo + hi) / 2;
+            if (old[tails[mid]] < old[i]) lo = mid + 1;
+            else hi = mid;
+        }
+        prev[i] = lo ? tails[lo - 1] : G_MAXUINT;
+        tails[lo] = i;
+        if (lo == len) ++len;
+    }
+
+    keep = g_new0(gboolean, n);
+    for (i = len ? tails[len - 1] : G_MAXUINT; i != G_MAXUINT; i = prev[i])
+        keep[i] = TRUE;
+
+    win = g_new(Window, n + 1);
+    for (i = 0; i < n; i = j) {
+        if (keep[i]) {
+            j = i + 1;
+            continue;
+        }
+
+        win[0] = i ? window_top(wins[i - 1]) : screen_support_win;
+        for (j = i, k = 1; j < n && !keep[j]; ++j, ++k) {
+            win[k] = window_top(wins[j]);
+            g_assert(win[k] != None); /* better not call stacking shit before
+                                         setting your top level window value */
+        }
+        XRestackWindows(obt_display, win, k);
+    }
+
+    g_free(win);
+    g_free(keep);
+    g_free(prev);
+    g_free(tails);
+    g_free(old);
+    g_free(wins);
+}
+
+void stacking_begin(void)
+{
+    GList *it;
     gint i;
 
+    if (transaction++) return;
+
+    /* remember the order on screen, unless it is frozen by a temporary
+       raise, in which case stacking_restore() will fix it all anyways */
+    if (!pause_changes) {
+        transaction_order = g_hash_table_new(g_direct_hash, g_direct_equal);
+        for (i = 1, it = stacking_list; it; ++i, it = g_list_next(it))
+            g_hash_table_insert(transaction_order, it->data,
+                                GINT_TO_POINTER(i));
+    }
+    transaction_changed = FALSE;
+}
+
+void stacking_commit(void)
+{
+    g_assert(transaction > 0);
+
+    if (--transaction) return;
+
+    if (transaction_changed) {
+        if (transaction_order && !pause_changes)
+            restack_changed();
+        stacking_set_list();
+    }
+
+    if (transaction_order) {
+        g_hash_table_destroy(transaction_order);
+        transaction_order = NULL;
+    }
+}
+
+static void do_restack(GList *wins, GList *before)
+{
+    GList *it;
+    guint n;
+
 #ifdef DEBUG
     GList *next;
 
@@ -84,21 +333,15 @@ static void do_restack(GList *wins, GList *before)
         g_assert(window_layer(it->data) >= window_layer(before->data));
 #endif
 
-    win = g_new(Window, g_list_length(wins) + 1);
+    /* only call this from inside a transaction, which will show the changes
+       when it is committed */
+    g_assert(transaction > 0);
 
-    if (before == stacking_list)
-        win[0] = screen_support_win;
-    else if (!before)
-        win[0] = window_top(g_list_last(stacking_list)->data);
-    else
-        win[0] = window_top(g_list_previous(before)->data);
+    for (it = wins, n = 0; it; it = g_list_next(it), ++n)
+        link_window(it->data, before);
 
-    for (i = 1, it = wins; it; ++i, it = g_list_next(it)) {
-        win[i] = window_top(it->data);
-        g_assert(win[i] != None); /* better not call stacking shit before
-                                     setting your top level window value */
-        stacking_list = g_list_insert_before(stacking_list, before, it->data);
-    }
+    recorder_record(OB_RECORD_RESTACK, 0, window_top(wins->data), n,
+                    before ? window_top(before->data) : 0, 0, 0);
 
 #ifdef DEBUG
     /* some debug checking of the stacking list's order */
@@ -106,14 +349,11 @@ static void do_restack(GList *wins, GList *before)
         next = g_list_next(it);
         if (!next) break;
         g_assert(window_layer(it->data) >= window_layer(next->data));
+        g_assert(window_key(it->data) < window_key(next->data));
     }
 #endif
 
-    if (!pause_changes)
-        XRestackWindows(obt_display, win, i);
-    g_free(win);
-
-    stacking_set_list();
+    transaction_changed = TRUE;
 }
 
 void stacking_temp_raise(ObWindow *window)
@@ -150,7 +390,7 @@ void stacking_restore(void)
     gint i;
     gulong start;
 
-    win = g_new(Window, g_list_length(stacking_list) + 1);
+    win = g_new(Window, stacking_length + 1);
     win[0] = screen_support_win;
     for (i = 1, it = stacking_list; it; ++i, it = g_list_next(it))
         win[i] = window_top(it->data);
@@ -175,14 +415,10 @@ static void do_raise(GList *wins)
         layer[l] = g_list_append(layer[l], it->data);
     }
 
-    it = stacking_list;
     for (i = OB_NUM_STACKING_LAYERS - 1; i >= 0; --i) {
         if (layer[i]) {
-            for (; it; it = g_list_next(it)) {
-                /* look for the top of the layer */
-                if (window_layer(it->data) <= (ObStackingLayer) i)
-                    break;
-            }
+            /* go above the top of the layer */
+            it = layer_top[i] ? layer_top[i] : below_layer(i);
             do_restack(layer[i], it);
             g_list_free(layer[i]);
         }
@@ -202,15 +438,10 @@ static void do_lower(GList *wins)
         layer[l] = g_list_append(layer[l], it->data);
     }
 
-    it = stacking_list;
     for (i = OB_NUM_STACKING_LAYERS - 1; i >= 0; --i) {
         if (layer[i]) {
-            for (; it; it = g_list_next(it)) {
-                /* look for the top of the next layer down */
-                if (window_layer(it->data) < (ObStackingLayer) i)
-                    break;
-            }
-            do_restack(layer[i], it);
+            /* go above the top of the next layer down */
+            do_restack(layer[i], below_layer(i));
             g_list_free(layer[i]);
         }
     }
@@ -218,7 +449,7 @@ static void do_lower(GList *wins)
 
 static void restack_windows(ObClient *selected, gboolean raise)
 {
-    GList *it, *last, *below, *above, *next;
+    GList *it, *below, *above, *next;
     GList *wins = NULL;
 
     GList *group_helpers = NULL;
@@ -237,14 +468,15 @@ static void restack_windows(ObClient *selected, gboolean raise)
     }
 
     /* remove first so we can't run into ourself */
-    it = g_list_find(stacking_list, selected);
-    g_assert(it);
-    stacking_list = g_list_delete_link(stacking_list, it);
+    unlink_window(CLIENT_AS_WINDOW(selected));
 
-    /* go from the bottom of the stacking list up. don't move any other windows
-       when lowering, we call this for each window independently */
+    /* go from the bottom of the selected window's layer up. don't move any
+       other windows when lowering, we call this for each window
+       independently */
     if (raise) {
-        for (it = g_list_last(stacking_list); it; it = next) {
+        it = below_layer(selected->layer);
+        it = it ? g_list_previous(it) : stacking_list_tail;
+        for (; it && window_layer(it->data) == selected->layer; it = next) {
             next = g_list_previous(it);
 
             if (WINDOW_IS_CLIENT(it->data)) {
@@ -275,7 +507,7 @@ static void restack_windows(ObClient *selected, gboolean raise)
                         else
                             group_trans = g_list_prepend(group_trans, ch);
                     }
-                    stacking_list = g_list_delete_link(stacking_list, it);
+                    unlink_window(it->data);
                 }
             }
         }
@@ -301,33 +533,18 @@ static void restack_windows(ObClient *selected, gboolean raise)
         group_trans = NULL;
     }
 
-    /* find where to put the selected window, start from bottom of list,
-       this is the window below everything we are re-adding to the list */
-    last = NULL;
-    for (it = g_list_last(stacking_list); it; it = g_list_previous(it))
-    {
-        if (window_layer(it->data) < selected->layer) {
-            last = it;
-            continue;
-        }
-        /* if lowering, stop at the beginning of the layer */
-        if (!raise)
-            break;
-        /* if raising, stop at the end of the layer */
-        if (window_layer(it->data) > selected->layer)
-            break;
-
-        last = it;
-    }
-
-    /* save this position in the stacking list */
-    below = last;
-
-    /* find where to put the group transients, start from the top of list */
-    for (it = stacking_list; it; it = g_list_next(it)) {
-        /* skip past higher layers */
-        if (window_layer(it->data) > selected->layer)
-            continue;
+    /* find where to put the selected window, this is the window below
+       everything we are re-adding to the list.  if raising, it goes at the
+       top of the layer, and if lowering, at the bottom of it */
+    below = below_layer(selected->layer);
+    if (raise && layer_top[selected->layer])
+        below = layer_top[selected->layer];
+
+    /* find where to put the group transients, start from the top of the
+       layer */
+    it = layer_top[selected->layer];
+    if (!it) it = below;
+    for (; it; it = g_list_next(it)) {
         /* if we reach the end of the layer (how?) then don't go further */
         if (window_layer(it->data) < selected->layer)
             break;
@@ -350,17 +567,17 @@ static void restack_windows(ObClient *selected, gboolean raise)
        we actually want to save 1 position _above_ that, for for loops to work
        nicely, so move back one position in the list while saving it
     */
-    above = it ? g_list_previous(it) : g_list_last(stacking_list);
+    above = it ? g_list_previous(it) : stacking_list_tail;
 
     /* put the windows inside the gap to the other windows we're stacking
        into the restacking list, go from the bottom up so that we can use
        g_list_prepend */
     if (below) it = g_list_previous(below);
-    else       it = g_list_last(stacking_list);
+    else       it = stacking_list_tail;
     for (; it != above; it = next) {
         next = g_list_previous(it);
         wins = g_list_prepend(wins, it->data);
-        stacking_list = g_list_delete_link(stacking_list, it);
+        unlink_window(it->data);
     }
 
     /* group transients go above the rest of the stuff acquired to now */
@@ -379,7 +596,7 @@ static void restack_windows(ObClient *selected, gboolean raise)
         parents_copy = g_slist_copy(selected->parents);
 
         /* go thru stacking list backwards so we can use g_slist_prepend */
-        for (it = g_list_last(stacking_list); it && parents_copy;
+        for (it = stacking_list_tail; it && parents_copy;
              it = g_list_previous(it))
             if ((sit = g_slist_find(parents_copy, it->data))) {
                 reorder = g_slist_prepend(reorder, sit->data);
@@ -395,6 +612,7 @@ static void restack_windows(ObClient *selected, gboolean raise)
 
 void stacking_raise(ObWindow *window)
 {
+    stacking_begin();
     if (WINDOW_IS_CLIENT(window)) {
         ObClient *selected;
         selected = WINDOW_AS_CLIENT(window);
@@ -402,15 +620,16 @@ void stacking_raise(ObWindow *window)
     } else {
         GList *wins;
         wins = g_list_append(NULL, window);
-        stacking_list = g_list_remove(stacking_list, window);
+        unlink_window(window);
         do_raise(wins);
         g_list_free(wins);
     }
-    stacking_list_tail = g_list_last(stacking_list);
+    stacking_commit();
 }
 
 void stacking_lower(ObWindow *window)
 {
+    stacking_begin();
     if (WINDOW_IS_CLIENT(window)) {
         ObClient *selected;
         selected = WINDOW_AS_CLIENT(window);
@@ -418,11 +637,11 @@ void stacking_lower(ObWindow *window)
     } else {
         GList *wins;
         wins = g_list_append(NULL, window);
-        stacking_list = g_list_remove(stacking_list, window);
+        unlink_window(window);
         do_lower(wins);
         g_list_free(wins);
     }
-    stacking_list_tail = g_list_last(stacking_list);
+    stacking_commit();
 }
 
 void stacking_below(ObWindow *window, ObWindow *below)
@@ -432,12 +651,13 @@ void stacking_below(ObWindow *window, ObWindow *below)
     if (window_layer(window) != window_layer(below))
         return;
 
+    stacking_begin();
     wins = g_list_append(NULL, window);
-    stacking_list = g_list_remove(stacking_list, window);
-    before = g_list_next(g_list_find(stacking_list, below));
+    unlink_window(window);
+    before = g_list_next(find_link(below));
     do_restack(wins, before);
     g_list_free(wins);
-    stacking_list_tail = g_list_last(stacking_list);
+    stacking_commit();
 }
 
 void stacking_add(ObWindow *win)
@@ -447,10 +667,15 @@ void stacking_add(ObWindow *win)
     /* don't add windows that are being unmanaged ! */
     if (WINDOW_IS_CLIENT(win)) g_assert(WINDOW_AS_CLIENT(win)->managed);
 
-    stacking_list = g_list_append(stacking_list, win);
-
     stacking_raise(win);
-    /* stacking_list_tail set by stacking_raise() */
+}
+
+void stacking_remove(gpointer win)
+{
+    unlink_window(win);
+    /* if it comes back during the transaction, it has to be restacked */
+    if (transaction_order)
+        g_hash_table_remove(transaction_order, win);
 }
 
 static GList *find_highest_relative(ObClient *client)
@@ -464,14 +689,15 @@ static GList *find_highest_relative(ObClient *client)
         /* get all top level relatives of this client */
         top = client_search_all_top_parents_layer(client);
 
-        /* go from the top of the stacking order down */
-        for (it = stacking_list; !ret && it; it = g_list_next(it)) {
+        /* go from the top of the client's layer down */
+        for (it = layer_top[client->layer];
+             !ret && it && window_layer(it->data) == client->layer;
+             it = g_list_next(it))
+        {
             if (WINDOW_IS_CLIENT(it->data)) {
                 ObClient *c = it->data;
-                /* only look at windows in the same layer and that are
-                   visible */
-                if (c->layer == client->layer &&
-                    !c->iconic &&
+                /* only look at windows that are visible */
+                if (!c->iconic &&
                     (c->desktop == client->desktop ||
                      c->desktop == DESKTOP_ALL ||
                      client->desktop == DESKTOP_ALL))
@@ -520,7 +746,7 @@ void stacking_add_nonintrusive(ObWindow *win)
         if (focus_client && client != focus_client &&
             focus_client->layer == client->layer)
         {
-            it_below = g_list_find(stacking_list, focus_client);
+            it_below = find_link(CLIENT_AS_WINDOW(focus_client));
             /* this can give NULL, but it means the focused window is on the
                bottom of the stacking order, so go to the bottom in that case,
                below it */
@@ -555,15 +781,16 @@ void stacking_add_nonintrusive(ObWindow *win)
         /* stop when the window is not in a lower layer than the
            window it is going under (it_above) */
         it_above = it_below ?
-            g_list_previous(it_below) : g_list_last(stacking_list);
+            g_list_previous(it_below) : stacking_list_tail;
         if (client->layer <= window_layer(it_above->data))
             break;
     }
 
     wins = g_list_append(NULL, win);
+    stacking_begin();
     do_restack(wins, it_below);
+    stacking_commit();
     g_list_free(wins);
-    stacking_list_tail = g_list_last(stacking_list);
 }
 
 /*! Returns TRUE if client is occluded by the sibling. If sibling is NULL it
@@ -582,7 +809,7 @@ static gboolean stacking_occluded(ObClient *client, ObWindow *sibling_win)
     if (sibling && client->layer != sibling->layer)
         return FALSE;
 
-    for (it = g_list_previous(g_list_find(stacking_list, client)); it;
+    for (it = g_list_previous(find_link(CLIENT_AS_WINDOW(client))); it;
          it = g_list_previous(it))
         if (WINDOW_IS_CLIENT(it->data)) {
             ObClient *c = it->data;
@@ -642,7 +869,7 @@ static gboolean stacking_occludes(ObClient *client, ObWindow *sibling_win)
     if (sibling && client->layer != sibling->layer)
         return FALSE;
 
-    for (it = g_list_next(g_list_find(stacking_list, client));
+    for (it = g_list_next(find_link(CLIENT_AS_WINDOW(client)));
          it; it = g_list_next(it))
         if (WINDOW_IS_CLIENT(it->data)) {
             ObClient *c = it->data;
@@ -47,9 +47,26 @@ extern GList *stacking_list_tail;
   stacking_list */
 void stacking_set_list(void);
 
+/*! Begins a stacking transaction.  Until the matching stacking_commit(),
+  raises and lowers only reorder the stacking_list.  Transactions may be
+  nested, and the changes are sent to the X server when the outermost one is
+  committed.
+*/
+void stacking_begin(void);
+/*! Ends a stacking transaction.  When the outermost transaction ends, the
+  windows which changed position are restacked on screen with as few requests
+  as possible, and the stacking list on the root window is updated once.
+*/
+void stacking_commit(void);
+
+/*! Sorts a list of ObWindow*s which are in the stacking_list into their
+  stacking order, from highest to lowest, or from lowest to highest if
+  @top_first is FALSE.  This costs no more for a long stacking_list. */
+GList* stacking_sort(GList *wins, gboolean top_first);
+
 void stacking_add(struct _ObWindow *win);
 void stacking_add_nonintrusive(struct _ObWindow *win);
-#define stacking_remove(win) stacking_list = g_list_remove(stacking_list, win);
+void stacking_remove(gpointer win);
 
 /*! Raises a window above all others in its stacking layer */
 void stacking_raise(struct _ObWindow *window);
@@ -26,6 +26,7 @@
 #include "prompt.h"
 #include "debug.h"
 #include "grab.h"
+#include "stacking.h"
 #include "obt/prop.h"
 #include "obt/xqueue.h"
 
@@ -104,12 +105,67 @@ void window_remove(Window xwin)
     g_hash_table_remove(window_map, &xwin);
 }
 
+static gboolean check_unmap(XEvent *e, gpointer data)
+{
+    const Window win = *(Window*)data;
+    return ((e->type == DestroyNotify && e->xdestroywindow.window == win) ||
+            (e->type == UnmapNotify && e->xunmap.window == win));
+}
+
+/*! Manages a window using the attributes and hints already fetched for it.
+  The server must be grabbed, and the grab is released once here. */
+static void manage(Window win, const XWindowAttributes *attrib,
+                   const XWMHints *wmhints)
+{
+    gboolean is_dockapp = FALSE;
+    Window icon_win = None;
+
+    /* is the window a docking app */
+    if (wmhints && (wmhints->flags & StateHint) &&
+        wmhints->initial_state == WithdrawnState)
+    {
+        if (wmhints->flags & IconWindowHint)
+            icon_win = wmhints->icon_window;
+        is_dockapp = TRUE;
+    }
+    /* This is a new method to declare that a window is a dockapp, being
+       implemented by Windowmaker, to alleviate pain in writing GTK+
+       dock apps.
+       http://thread.gmane.org/gmane.comp.window-managers.openbox/4881
+    */
+    if (!is_dockapp) {
+        gchar **ss;
+        if (OBT_PROP_GETSS_TYPE(win, WM_CLASS, STRING_NO_CC, &ss))
+        {
+            if (ss[0] && ss[1] && strcmp(ss[1], "DockApp") == 0)
+                is_dockapp = TRUE;
+            g_strfreev(ss);
+        }
+    }
+
+    if (attrib->override_redirect) {
+        ob_debug("not managing override redirect window 0x%x", win);
+        grab_server(FALSE);
+    }
+    else if (is_dockapp) {
+        if (!icon_win)
+            icon_win = win;
+        dock_manage(icon_win, win);
+    }
+    else
+        client_manage(win, NULL);
+}
+
 void window_manage_all(void)
 {
     guint i, j, nchild;
     Window w, *children;
-    XWMHints *wmhints;
-    XWindowAttributes attrib;
+    XWindowAttributes *attribs;
+    XWMHints **wmhints;
+
+    /* hold the server for the whole time, so nothing can change underneath
+       us, and so managing each window doesn't have to wait to grab it */
+    grab_server(TRUE);
 
     if (!XQueryTree(obt_display, RootWindow(obt_display, ob_screen),
                     &w, &w, &children, &nchild)) {
@@ -117,50 +173,54 @@ void window_manage_all(void)
         nchild = 0;
     }
 
+    /* fetch everything about the windows once, up front */
+    attribs = g_new(XWindowAttributes, nchild);
+    wmhints = g_new0(XWMHints*, nchild);
+    for (i = 0; i < nchild; i++) {
+        if (window_find(children[i])) /* skip our own windows */
+            children[i] = None;
+        else if (!XGetWindowAttributes(obt_display, children[i], &attribs[i]))
+            children[i] = None;
+        else
+            wmhints[i] = XGetWMHints(obt_display, children[i]);
+    }
+
     /* remove all icon windows from the list */
     for (i = 0; i < nchild; i++) {
-        if (children[i] == None) continue;
-        wmhints = XGetWMHints(obt_display, children[i]);
-        if (wmhints) {
-            if ((wmhints->flags & IconWindowHint) &&
-                (wmhints->icon_window != children[i]))
-                for (j = 0; j < nchild; j++)
-                    if (children[j] == wmhints->icon_window) {
-                        /* XXX watch the window though */
-                        children[j] = None;
-                        break;
-                    }
-            XFree(wmhints);
-        }
+        if (children[i] == None || !wmhints[i]) continue;
+        if ((wmhints[i]->flags & IconWindowHint) &&
+            (wmhints[i]->icon_window != children[i]))
+            for (j = 0; j < nchild; j++)
+                if (children[j] == wmhints[i]->icon_window) {
+                    /* XXX watch the window though */
+                    children[j] = None;
+                    break;
+                }
     }
 
+    /* manage them from the bottom up, and restack them all at the end */
+    stacking_begin();
     for (i = 0; i < nchild; ++i) {
         if (children[i] == None) continue;
-        if (window_find(children[i])) continue; /* skip our own windows */
-        if (XGetWindowAttributes(obt_display, children[i], &attrib)) {
-            if (attrib.map_state == IsUnmapped)
-                ;
-            else
-                window_manage(children[i]);
-        }
+        if (attribs[i].map_state == IsUnmapped) continue;
+        grab_server(TRUE);
+        manage(children[i], &attribs[i], wmhints[i]);
     }
+    stacking_commit();
 
+    for (i = 0; i < nchild; ++i)
+        if (wmhints[i]) XFree(wmhints[i]);
+    g_free(wmhints);
+    g_free(attribs);
     if (children) XFree(children);
-}
 
-static gboolean check_unmap(XEvent *e, gpointer data)
-{
-    const Window win = *(Window*)data;
-    return ((e->type == DestroyNotify && e->xdestroywindow.window == win) ||
-            (e->type == UnmapNotify && e->xunmap.window == win));
+    grab_server(FALSE);
 }
 
 void window_manage(Window win)
 {
     XWindowAttributes attrib;
-    gboolean no_manage = FALSE;
-    gboolean is_dockapp = FALSE;
-    Window icon_win = None;
+    XWMHints *wmhints;
 
     grab_server(TRUE);
 
@@ -168,58 +228,17 @@ void window_manage(Window win)
        mapping. the grab does a sync so we don't have to here */
     if (xqueue_exists_local(check_unmap, &win)) {
         ob_debug("Trying to manage unmapped window. Aborting that.");
-        no_manage = TRUE;
-    }
-    else if (!XGetWindowAttributes(obt_display, win, &attrib))
-        no_manage = TRUE;
-    else {
-        XWMHints *wmhints;
-
-        /* is the window a docking app */
-        is_dockapp = FALSE;
-        if ((wmhints = XGetWMHints(obt_display, win))) {
-            if ((wmhints->flags & StateHint) &&
-                wmhints->initial_state == WithdrawnState)
-            {
-                if (wmhints->flags & IconWindowHint)
-                    icon_win = wmhints->icon_window;
-                is_dockapp = TRUE;
-            }
-            XFree(wmhints);
-        }
-        /* This is a new method to declare that a window is a dockapp, being
-           implemented by Windowmaker, to alleviate pain in writing GTK+
-           dock apps.
-           http://thread.gmane.org/gmane.comp.window-managers.openbox/4881
-        */
-        if (!is_dockapp) {
-            gchar **ss;
-            if (OBT_PROP_GETSS_TYPE(win, WM_CLASS, STRING_NO_CC, &ss))
-            {
-                if (ss[0] && ss[1] && strcmp(ss[1], "DockApp") == 0)
-                    is_dockapp = TRUE;
-                g_strfreev(ss);
-            }
-        }
-    }
-
-    if (!no_manage) {
-        if (attrib.override_redirect) {
-            ob_debug("not managing override redirect window 0x%x", win);
-            grab_server(FALSE);
-        }
-        else if (is_dockapp) {
-            if (!icon_win)
-                icon_win = win;
-            dock_manage(icon_win, win);
-        }
-        else
-            client_manage(win, NULL);
+        grab_server(FALSE);
     }
-    else {
+    else if (!XGetWindowAttributes(obt_display, win, &attrib)) {
         grab_server(FALSE);
         ob_debug("FAILED to manage window 0x%x", win);
     }
+    else {
+        wmhints = XGetWMHints(obt_display, win);
+        manage(win, &attrib, wmhints);
+        if (wmhints) XFree(wmhints);
+    }
 }
 
 void window_unmanage_all(void)
@@ -0,0 +1,508 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   obbench.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox developers
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+/* Runs scripted workloads against a running Openbox and reports, for each
+   one, the wall time, how many X requests Openbox made, how many of them
+   were round trips (requests which Openbox had to wait on a reply for), and
+   how much cpu time Openbox used.  Run it through obbench.sh to get a fresh
+   Openbox on a headless Xvfb server, so the numbers can be compared between
+   builds.
+
+   usage: obbench [scenario ...]
+
+   The scenarios are run in the order given, or all of them in this order:
+     map       map 500 windows
+     titles    change the title of each window 10 times
+     desktops  switch desktops 200 times
+     alttab    Alt-Tab through 300 windows
+     menu      open and close a 2000 entry root menu 20 times
+     drag      Alt-drag a window across the screen with resistance
+
+   The windows mapped by "map" are reused by the scenarios after it, and are
+   mapped before the timing starts if it was not run.  The "menu" scenario
+   needs the root-menu to have 2000 entries, which obbench.sh sets up.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+#include <X11/keysym.h>
+#include <X11/extensions/XTest.h>
+#include <X11/extensions/record.h>
+
+#define MAP_WINDOWS     500
+#define TITLE_ROUNDS    10
+#define DESKTOP_SWITCHES 200
+#define ALTTAB_WINDOWS  300
+#define MENU_OPENS      20
+#define DRAG_STEPS      400
+
+/* how long to give a scenario before deciding Openbox is stuck */
+#define TIMEOUT         120
+
+static Display *display;
+static Window root;
+static Atom _client_list, _current_desktop, _wm_state, _above, _wm_name;
+static Atom _utf8, _openbox_pid, _supporting;
+
+static Window *wins;
+static int nwins = 0;
+/* a window Openbox manages, used to tell when Openbox has caught up */
+static Window probe;
+static int probe_above = 0;
+
+static Display *record_display;
+static XRecordContext record_context;
+static unsigned long requests, replies;
+static long ob_pid;
+
+static void die(const char *s)
+{
+  fprintf(stderr, "obbench: %s\n", s);
+  exit(1);
+}
+
+static double now(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+/* returns the cpu time Openbox has used so far, in milliseconds */
+static double ob_cpu(void)
+{
+  char path[64], buf[1024], *p;
+  unsigned long utime, stime;
+  FILE *f;
+  int n;
+
+  snprintf(path, sizeof(path), "/proc/%ld/stat", ob_pid);
+  if (!(f = fopen(path, "r")))
+    return 0;
+  n = fread(buf, 1, sizeof(buf) - 1, f);
+  fclose(f);
+  buf[n > 0 ? n : 0] = '\0';
+
+  /* skip past the process name, which can contain spaces */
+  if (!(p = strrchr(buf, ')')))
+    return 0;
+  if (sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+             &utime, &stime) != 2)
+    return 0;
+  return (utime + stime) * 1000.0 / sysconf(_SC_CLK_TCK);
+}
+
+static unsigned long get_window_prop(Window win, Atom prop, Atom type,
+                                     unsigned long **data)
+{
+  Atom ret_type;
+  int format;
+  unsigned long n, after;
+  unsigned char *d;
+
+  if (XGetWindowProperty(display, win, prop, 0, 0x7fffffff, False, type,
+                         &ret_type, &format, &n, &after, &d) != Success ||
+      ret_type != type || format != 32)
+    return 0;
+  if (data)
+    *data = (unsigned long*)d;
+  else
+    XFree(d);
+  return n;
+}
+
+/* counts the requests Openbox makes and the replies it gets */
+static void record_cb(XPointer priv, XRecordInterceptData *d)
+{
+  if (d->category == XRecordFromClient)
+    ++requests;
+  else if (d->category == XRecordFromServer)
+    ++replies;
+  XRecordFreeData(d);
+}
+
+static void record_start(Window obwin)
+{
+  XRecordRange *range;
+  XRecordClientSpec client;
+  int major, minor;
+
+  if (!(record_display = XOpenDisplay(NULL)))
+    die("couldn't open a second connection to the X server");
+  if (!XRecordQueryVersion(record_display, &major, &minor))
+    die("the X server doesn't have the RECORD extension");
+
+  /* everything Openbox sends, and every reply it gets back */
+  range = XRecordAllocRange();
+  range->core_requests.first = 1;
+  range->core_requests.last = 127;
+  range->ext_requests.ext_major.first = 128;
+  range->ext_requests.ext_major.last = 255;
+  range->ext_requests.ext_minor.first = 0;
+  range->ext_requests.ext_minor.last = 255;
+  range->core_replies.first = 1;
+  range->core_replies.last = 127;
+  range->ext_replies.ext_major.first = 128;
+  range->ext_replies.ext_major.last = 255;
+  range->ext_replies.ext_minor.first = 0;
+  range->ext_replies.ext_minor.last = 255;
+
+  /* a window made by Openbox picks out its connection */
+  client = obwin;
+  record_context = XRecordCreateContext(display, 0, &client, 1, &range, 1);
+  XFree(range);
+  if (!record_context)
+    die("couldn't make a RECORD context");
+  XSync(display, False);
+
+  if (!XRecordEnableContextAsync(record_display, record_context,
+                                 record_cb, NULL))
+    die("couldn't start recording");
+}
+
+/* reads everything recorded so far */
+static void record_drain(void)
+{
+  int fd = ConnectionNumber(record_display);
+
+  for (;;) {
+    fd_set set;
+    struct timeval tv = { 0, 50000 };
+
+    XRecordProcessReplies(record_display);
+    FD_ZERO(&set);
+    FD_SET(fd, &set);
+    if (select(fd + 1, &set, NULL, NULL, &tv) <= 0)
+      break;
+  }
+}
+
+static void send_msg(Window win, Atom type, long l0, long l1, long l2)
+{
+  XEvent msg;
+
+  msg.xclient.type = ClientMessage;
+  msg.xclient.message_type = type;
+  msg.xclient.display = display;
+  msg.xclient.window = win;
+  msg.xclient.format = 32;
+  msg.xclient.data.l[0] = l0;
+  msg.xclient.data.l[1] = l1;
+  msg.xclient.data.l[2] = l2;
+  msg.xclient.data.l[3] = 0l;
+  msg.xclient.data.l[4] = 0l;
+  XSendEvent(display, root, False,
+             SubstructureNotifyMask | SubstructureRedirectMask, &msg);
+}
+
+/* waits for an event matching the given type, window and property.  use 0
+   for a window or property that doesn't matter */
+static void wait_for(int type, Window win, Atom prop)
+{
+  XEvent e;
+
+  XFlush(display);
+  for (;;) {
+    XNextEvent(display, &e);
+    if (e.type != type) continue;
+    if (type == PropertyNotify) {
+      if ((!win || e.xproperty.window == win) &&
+          (!prop || e.xproperty.atom == prop))
+        return;
+    }
+    else if (type == MapNotify) {
+      if ((!win || e.xmap.window == win) && e.xmap.override_redirect)
+        return;
+    }
+    else if (type == UnmapNotify) {
+      if (!win || e.xunmap.window == win)
+        return;
+    }
+    else
+      return;
+  }
+}
+
+/* Openbox handles events in order, so once it has changed the probe
+   window's state, it has dealt with everything that came before */
+static void fence(void)
+{
+  probe_above = !probe_above;
+  send_msg(probe, _wm_state, probe_above ? 1 : 0, _above, 0);
+  wait_for(PropertyNotify, probe, _wm_state);
+}
+
+static Window make_window(int i, int x, int y)
+{
+  Window w;
+  char name[32];
+
+  w = XCreateWindow(display, root, x, y, 100, 100, 0,
+                    CopyFromParent, CopyFromParent, CopyFromParent, 0, NULL);
+  XSetWindowBackground(display, w, WhitePixel(display, 0));
+  snprintf(name, sizeof(name), "obbench %d", i);
+  XStoreName(display, w, name);
+  XSelectInput(display, w, PropertyChangeMask);
+  return w;
+}
+
+static unsigned long client_list_length(void)
+{
+  return get_window_prop(root, _client_list, XA_WINDOW, NULL);
+}
+
+/* maps windows until there are at least n */
+static void ensure_windows(int n)
+{
+  unsigned long want;
+  int i;
+
+  if (nwins >= n) return;
+
+  want = client_list_length() + (n - nwins);
+  wins = realloc(wins, sizeof(Window) * n);
+  for (i = nwins; i < n; ++i) {
+    wins[i] = make_window(i, (i * 7) % 500, (i * 13) % 400);
+    XMapWindow(display, wins[i]);
+  }
+  nwins = n;
+
+  while (client_list_length() < want)
+    wait_for(PropertyNotify, root, _client_list);
+  fence();
+}
+
+static void run_map(void)
+{
+  if (nwins)
+    fprintf(stderr, "obbench: map should be run first\n");
+  ensure_windows(MAP_WINDOWS);
+}
+
+static void setup_windows(void)
+{
+  ensure_windows(MAP_WINDOWS);
+}
+
+static void run_titles(void)
+{
+  char name[64];
+  int r, i;
+
+  for (r = 0; r < TITLE_ROUNDS; ++r) {
+    for (i = 0; i < nwins; ++i) {
+      snprintf(name, sizeof(name), "obbench %d title %d", i, r);
+      XStoreName(display, wins[i], name);
+      XChangeProperty(display, wins[i], _wm_name, _utf8, 8,
+                      PropModeReplace, (unsigned char*)name, strlen(name));
+    }
+    fence();
+  }
+}
+
+static void run_desktops(void)
+{
+  int i;
+
+  for (i = 1; i <= DESKTOP_SWITCHES; ++i) {
+    send_msg(root, _current_desktop, i % 4, CurrentTime, 0);
+    fence();
+  }
+}
+
+static void key(KeySym sym, Bool press)
+{
+  XTestFakeKeyEvent(display, XKeysymToKeycode(display, sym), press, 0);
+}
+
+static void setup_alttab(void)
+{
+  ensure_windows(ALTTAB_WINDOWS);
+}
+
+static void run_alttab(void)
+{
+  int i;
+
+  key(XK_Alt_L, True);
+  for (i = 0; i < ALTTAB_WINDOWS; ++i) {
+    key(XK_Tab, True);
+    key(XK_Tab, False);
+  }
+  key(XK_Alt_L, False);
+  fence();
+}
+
+static void run_menu(void)
+{
+  int i;
+
+  /* the bottom right corner is left clear of the windows */
+  XTestFakeMotionEvent(display, 0, DisplayWidth(display, 0) - 10,
+                       DisplayHeight(display, 0) - 10, 0);
+  for (i = 0; i < MENU_OPENS; ++i) {
+    XTestFakeButtonEvent(display, 3, True, 0);
+    XTestFakeButtonEvent(display, 3, False, 0);
+    wait_for(MapNotify, None, None);
+    key(XK_Escape, True);
+    key(XK_Escape, False);
+    wait_for(UnmapNotify, None, None);
+  }
+  fence();
+}
+
+static void run_drag(void)
+{
+  Window w = wins[nwins - 1], child;
+  int x, y, i, step;
+
+  /* grab the top window by its middle */
+  XRaiseWindow(display, w);
+  fence();
+  XTranslateCoordinates(display, w, root, 50, 50, &x, &y, &child);
+  XTestFakeMotionEvent(display, 0, x, y, 0);
+
+  key(XK_Alt_L, True);
+  XTestFakeButtonEvent(display, 1, True, 0);
+  /* drag it over the other windows and into the edges of the screen, and
+     back again */
+  for (step = 3, i = 0; i < DRAG_STEPS * 2; ++i) {
+    if (i == DRAG_STEPS) step = -step;
+    x += step;
+    y += step / 3;
+    XTestFakeMotionEvent(display, 0, x, y, 0);
+  }
+  XTestFakeButtonEvent(display, 1, False, 0);
+  key(XK_Alt_L, False);
+  fence();
+}
+
+static const struct {
+  const char *name;
+  void (*setup)(void);
+  void (*run)(void);
+} scenarios[] = {
+  { "map",      NULL,          run_map },
+  { "titles",   setup_windows, run_titles },
+  { "desktops", setup_windows, run_desktops },
+  { "alttab",   setup_alttab,  run_alttab },
+  { "menu",     setup_windows, run_menu },
+  { "drag",     setup_windows, run_drag }
+};
+#define NUM_SCENARIOS (int)(sizeof(scenarios) / sizeof(scenarios[0]))
+
+static void run(int s)
+{
+  double wall, cpu;
+
+  if (scenarios[s].setup)
+    scenarios[s].setup();
+  record_drain();
+  requests = replies = 0;
+
+  alarm(TIMEOUT);
+  cpu = ob_cpu();
+  wall = now();
+  scenarios[s].run();
+  wall = now() - wall;
+  cpu = ob_cpu() - cpu;
+  alarm(0);
+
+  record_drain();
+  printf("%-10s %10.1f %10lu %11lu %10.1f\n", scenarios[s].name,
+         wall, requests, replies, cpu);
+  fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+  unsigned long *data;
+  Window obwin;
+  int i, s;
+
+  display = XOpenDisplay(NULL);
+
+  if (display == NULL)
+    die("couldn't connect to the X server");
+  root = RootWindow(display, 0);
+
+  _client_list = XInternAtom(display, "_NET_CLIENT_LIST", False);
+  _current_desktop = XInternAtom(display, "_NET_CURRENT_DESKTOP", False);
+  _wm_state = XInternAtom(display, "_NET_WM_STATE", False);
+  _above = XInternAtom(display, "_NET_WM_STATE_ABOVE", False);
+  _wm_name = XInternAtom(display, "_NET_WM_NAME", False);
+  _utf8 = XInternAtom(display, "UTF8_STRING", False);
+  _openbox_pid = XInternAtom(display, "_OPENBOX_PID", False);
+  _supporting = XInternAtom(display, "_NET_SUPPORTING_WM_CHECK", False);
+
+  XSelectInput(display, root, PropertyChangeMask | SubstructureNotifyMask);
+
+  /* wait for Openbox to be running */
+  while (!get_window_prop(root, _supporting, XA_WINDOW, &data))
+    wait_for(PropertyNotify, root, _supporting);
+  obwin = data[0];
+  XFree(data);
+  if (!get_window_prop(root, _openbox_pid, XA_CARDINAL, &data))
+    die("the window manager isn't Openbox");
+  ob_pid = data[0];
+  XFree(data);
+
+  record_start(obwin);
+
+  /* the probe window goes in the corner, away from the others */
+  probe = make_window(-1, 0, DisplayHeight(display, 0) - 100);
+  XMapWindow(display, probe);
+  wait_for(PropertyNotify, probe, _wm_state);
+
+  printf("%-10s %10s %10s %11s %10s\n",
+         "scenario", "wall ms", "requests", "round trips", "cpu ms");
+
+  if (argc > 1) {
+    for (i = 1; i < argc; ++i) {
+      for (s = 0; s < NUM_SCENARIOS; ++s)
+        if (!strcmp(argv[i], scenarios[s].name)) break;
+      if (s == NUM_SCENARIOS) {
+        fprintf(stderr, "obbench: unknown scenario %s\n", argv[i]);
+        return 1;
+      }
+      run(s);
+    }
+  }
+  else
+    for (s = 0; s < NUM_SCENARIOS; ++s)
+      run(s);
+
+  XRecordDisableContext(display, record_context);
+  XRecordFreeContext(display, record_context);
+  XCloseDisplay(record_display);
+  for (i = 0; i < nwins; ++i)
+    XDestroyWindow(display, wins[i]);
+  XDestroyWindow(display, probe);
+  XCloseDisplay(display);
+  free(wins);
+
+  return 0;
+}
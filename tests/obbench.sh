@@ -0,0 +1,72 @@
+#!/bin/sh
+
+# Runs obbench against a fresh Openbox on a headless Xvfb server, with the
+# default rc.xml and a root menu of 2000 entries.  Run it from the tests
+# directory after building obbench with "make obbench".
+#
+# usage: obbench.sh [path/to/openbox] [scenario ...]
+#
+# Set OBBENCH_DISPLAY to use a display other than :91.
+
+OPENBOX=../openbox/openbox
+if [ -n "$1" ] && [ -x "$1" ]; then
+    OPENBOX=$1
+    shift
+fi
+DPY=${OBBENCH_DISPLAY:-:91}
+DATA=$(dirname "$0")/../data
+
+if [ ! -x ./obbench ]; then
+    echo "obbench.sh: build obbench first with \"make obbench\"" >&2
+    exit 1
+fi
+
+TMP=$(mktemp -d) || exit 1
+XVFB=
+OB=
+cleanup() {
+    [ -n "$OB" ] && kill $OB 2>/dev/null
+    [ -n "$XVFB" ] && kill $XVFB 2>/dev/null
+    rm -rf "$TMP"
+}
+trap cleanup EXIT INT TERM
+
+# the default config, with a big root menu
+mkdir -p "$TMP/openbox" "$TMP/cache"
+cp "$DATA/rc.xml" "$TMP/openbox/rc.xml"
+{
+    echo '<?xml version="1.0" encoding="UTF-8"?>'
+    echo '<openbox_menu xmlns="http://openbox.org/3.4/menu">'
+    echo '<menu id="root-menu" label="Openbox 3">'
+    i=0
+    while [ $i -lt 2000 ]; do
+        echo "<item label=\"Entry $i\"><action name=\"Execute\">"
+        echo "<command>true</command></action></item>"
+        i=$((i + 1))
+    done
+    echo '</menu>'
+    echo '</openbox_menu>'
+} > "$TMP/openbox/menu.xml"
+
+Xvfb $DPY -screen 0 1280x1024x24 -nolisten tcp >"$TMP/xvfb.log" 2>&1 &
+XVFB=$!
+sleep 1
+if ! kill -0 $XVFB 2>/dev/null; then
+    cat "$TMP/xvfb.log" >&2
+    exit 1
+fi
+
+DISPLAY=$DPY XDG_CONFIG_HOME="$TMP" XDG_CACHE_HOME="$TMP/cache" \
+    "$OPENBOX" --sm-disable >"$TMP/openbox.log" 2>&1 &
+OB=$!
+
+# obbench waits for openbox to finish starting
+DISPLAY=$DPY ./obbench "$@"
+STATUS=$?
+
+if ! kill -0 $OB 2>/dev/null; then
+    echo "obbench.sh: openbox exited, its output was:" >&2
+    cat "$TMP/openbox.log" >&2
+    STATUS=1
+fi
+exit $STATUS
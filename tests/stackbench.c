@@ -0,0 +1,155 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   stackbench.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox developers
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+/* Maps a lot of windows (1000 by default) and then times how long the window
+   manager takes to raise and lower them one at a time, by waiting for it to
+   update _NET_CLIENT_LIST_STACKING after each request.
+
+   usage: stackbench [windows] [restacks]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+
+static Display *display;
+static Atom _restack, _stacking;
+
+static long stacking_length(void)
+{
+  Atom type;
+  int format;
+  unsigned long n, after;
+  unsigned char *data;
+
+  if (XGetWindowProperty(display, RootWindow(display, 0), _stacking,
+                         0, 0, False, XA_WINDOW, &type, &format, &n, &after,
+                         &data) != Success || type != XA_WINDOW)
+    return 0;
+  XFree(data);
+  return after / 4;
+}
+
+static void wait_for_stacking(void)
+{
+  XEvent report;
+
+  do {
+    XNextEvent(display, &report);
+  } while (report.type != PropertyNotify ||
+           report.xproperty.atom != _stacking);
+}
+
+static void restack(Window win, int detail)
+{
+  XEvent msg;
+
+  msg.xclient.type = ClientMessage;
+  msg.xclient.message_type = _restack;
+  msg.xclient.display = display;
+  msg.xclient.window = win;
+  msg.xclient.format = 32;
+  msg.xclient.data.l[0] = 2l;
+  msg.xclient.data.l[1] = 0l;
+  msg.xclient.data.l[2] = detail;
+  msg.xclient.data.l[3] = 0l;
+  msg.xclient.data.l[4] = 0l;
+  XSendEvent(display, RootWindow(display, 0), False,
+             SubstructureNotifyMask | SubstructureRedirectMask, &msg);
+  XFlush(display);
+}
+
+static double now(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+int main (int argc, char **argv) {
+  Window    *wins;
+  int        nwins = 1000, nrestacks = 1000;
+  int        i;
+  long       start;
+  double     t, raise = 0, lower = 0;
+
+  if (argc > 1) nwins = atoi(argv[1]);
+  if (argc > 2) nrestacks = atoi(argv[2]);
+  if (nwins < 1 || nrestacks < 1) {
+    fprintf(stderr, "usage: %s [windows] [restacks]\n", argv[0]);
+    return 1;
+  }
+
+  display = XOpenDisplay(NULL);
+
+  if (display == NULL) {
+    fprintf(stderr, "couldn't connect to X server :0\n");
+    return 0;
+  }
+
+  _restack = XInternAtom(display, "_NET_RESTACK_WINDOW", False);
+  _stacking = XInternAtom(display, "_NET_CLIENT_LIST_STACKING", False);
+
+  XSelectInput(display, RootWindow(display, 0), PropertyChangeMask);
+
+  start = stacking_length();
+
+  wins = malloc(sizeof(Window) * nwins);
+  for (i = 0; i < nwins; ++i) {
+    wins[i] = XCreateWindow(display, RootWindow(display, 0),
+                            (i * 7) % 500, (i * 13) % 400, 100, 100, 0,
+                            CopyFromParent, CopyFromParent,
+                            CopyFromParent, 0, NULL);
+    XSetWindowBackground(display, wins[i], WhitePixel(display, 0));
+    XMapWindow(display, wins[i]);
+  }
+  XFlush(display);
+
+  printf("waiting for %d windows to be managed\n", nwins);
+  while (stacking_length() < start + nwins)
+    wait_for_stacking();
+
+  srand(1);
+  for (i = 0; i < nrestacks; ++i) {
+    Window w = wins[rand() % nwins];
+
+    t = now();
+    restack(w, Above);
+    wait_for_stacking();
+    raise += now() - t;
+
+    t = now();
+    restack(w, Below);
+    wait_for_stacking();
+    lower += now() - t;
+  }
+
+  printf("%d windows, %d restacks\n", nwins, nrestacks);
+  printf("raise: %.3f ms average\n", raise / nrestacks);
+  printf("lower: %.3f ms average\n", lower / nrestacks);
+
+  for (i = 0; i < nwins; ++i)
+    XDestroyWindow(display, wins[i]);
+  XCloseDisplay(display);
+  free(wins);
+
+  return 0;
+}
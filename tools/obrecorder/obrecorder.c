@@ -0,0 +1,138 @@
+#include "openbox/recorder.h"
+
+#include <X11/X.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <glib.h>
+
+/* the names of the X event types, indexed by type */
+static const gchar *event_names[] = {
+    NULL, NULL,
+    "KeyPress", "KeyRelease", "ButtonPress", "ButtonRelease",
+    "MotionNotify", "EnterNotify", "LeaveNotify", "FocusIn", "FocusOut",
+    "KeymapNotify", "Expose", "GraphicsExpose", "NoExpose",
+    "VisibilityNotify", "CreateNotify", "DestroyNotify", "UnmapNotify",
+    "MapNotify", "MapRequest", "ReparentNotify", "ConfigureNotify",
+    "ConfigureRequest", "GravityNotify", "ResizeRequest",
+    "CirculateNotify", "CirculateRequest", "PropertyNotify",
+    "SelectionClear", "SelectionRequest", "SelectionNotify",
+    "ColormapNotify", "ClientMessage", "MappingNotify", "GenericEvent"
+};
+
+gint fail(const gchar *s) {
+    if (s)
+        fprintf(stderr, "%s\n", s);
+    else
+        fprintf
+            (stderr,
+             "Usage: obrecorder [OPTIONS] [FILE]\n\n"
+             "Shows the flight recorder written by \"openbox --dump-recorder\""
+             "\nor when Openbox crashed.  FILE defaults to\n"
+             "$XDG_CACHE_HOME/openbox/recorder.bin.\n\n"
+             "Options:\n"
+             "    --help              Display this help and exit\n"
+             "    --window ID         Only show records about this window\n");
+    return 1;
+}
+
+static void show_record(const ObRecord *r)
+{
+    printf("%8u %10u ", r->seq, r->time);
+
+    switch (r->kind) {
+    case OB_RECORD_EVENT:
+        if (r->type < G_N_ELEMENTS(event_names) && event_names[r->type])
+            printf("event     %-17s", event_names[r->type]);
+        else
+            printf("event     %-17d", r->type);
+        printf(" 0x%-8x serial %u\n", r->window, r->arg[0]);
+        break;
+    case OB_RECORD_FOCUS:
+        printf("focus     %-17s 0x%-8x from 0x%x\n", "",
+               r->window, r->arg[0]);
+        break;
+    case OB_RECORD_RESTACK:
+        printf("restack   %-17s 0x%-8x %u window(s) above ", "",
+               r->window, r->arg[0]);
+        if (r->arg[1])
+            printf("0x%x\n", r->arg[1]);
+        else
+            printf("the bottom\n");
+        break;
+    case OB_RECORD_CONFIGURE:
+        printf("configure %-17s 0x%-8x %d %d %ux%u\n",
+               r->type ? "(user)" : "", r->window,
+               (gint32)r->arg[0], (gint32)r->arg[1], r->arg[2], r->arg[3]);
+        break;
+    default:
+        printf("unknown   %-17d 0x%-8x %u %u %u %u\n", r->kind,
+               r->window, r->arg[0], r->arg[1], r->arg[2], r->arg[3]);
+        break;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    gchar *path = NULL;
+    gchar *contents;
+    gsize len;
+    GError *err = NULL;
+    const ObRecorderHeader *h;
+    const ObRecord *r;
+    guint32 i, window = 0;
+    gboolean by_window = FALSE;
+    gint ret = 0;
+
+    for (i = 1; i < (guint32)argc; ++i) {
+        if (!strcmp(argv[i], "--help"))
+            return fail(NULL);
+        else if (!strcmp(argv[i], "--window")) {
+            if (++i == (guint32)argc)
+                return fail(NULL);
+            window = strtoul(argv[i], NULL, 0);
+            by_window = TRUE;
+        }
+        else if (*argv[i] == '-')
+            return fail(NULL);
+        else if (path)
+            return fail(NULL);
+        else
+            path = g_strdup(argv[i]);
+    }
+
+    if (!path)
+        path = g_build_filename(g_get_user_cache_dir(), "openbox",
+                                "recorder.bin", NULL);
+
+    if (!g_file_get_contents(path, &contents, &len, &err)) {
+        ret = fail(err->message);
+        g_error_free(err);
+        g_free(path);
+        return ret;
+    }
+
+    h = (const ObRecorderHeader*)contents;
+    if (len < sizeof(*h) ||
+        memcmp(h->magic, OB_RECORDER_MAGIC, sizeof(h->magic)))
+        ret = fail("The file is not a flight recorder from Openbox.");
+    else if (h->version != OB_RECORDER_VERSION ||
+             h->record_size != sizeof(ObRecord))
+        ret = fail("The flight recorder was written by a different version "
+                   "of Openbox.");
+    else if (len < sizeof(*h) + (gsize)h->count * sizeof(ObRecord))
+        ret = fail("The flight recorder is truncated.");
+    else {
+        printf("%8s %10s %-9s %-17s %-10s\n",
+               "seq", "time", "kind", "", "window");
+
+        r = (const ObRecord*)(contents + sizeof(*h));
+        for (i = 0; i < h->count; ++i, ++r)
+            if (!by_window || r->window == window)
+                show_record(r);
+    }
+
+    g_free(contents);
+    g_free(path);
+    return ret;
+}
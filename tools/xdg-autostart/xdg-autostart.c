@@ -0,0 +1,280 @@
+/* -*- indent-tabs-mode: nil; tab-width: 4; c-basic-offset: 4; -*-
+
+   xdg-autostart.c for the Openbox window manager
+   Copyright (c) 2026        The Openbox developers
+
+   This replaces the openbox-xdg-autostart Python script, which is
+   Copyright (c) 2008-2010   Dana Jansens
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   See the COPYING file for a copy of the GNU General Public License.
+*/
+
+/* Runs things based on the XDG autostart specification, which can be found
+   here: http://standards.freedesktop.org/autostart-spec/
+*/
+
+#include "obt/link.h"
+#include "obt/paths.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+
+#define ME "openbox-xdg-autostart"
+
+typedef struct {
+    gchar *path;
+    ObtLink *link;
+} AutostartFile;
+
+static void show_help(void)
+{
+    g_print("Usage: %s [OPTION]... [ENVIRONMENT]...\n\n", ME);
+    g_print("This tool will run xdg autostart .desktop files\n\n");
+    g_print("OPTIONS\n");
+    g_print("  --list        Show a list of the files which would be run\n");
+    g_print("                Files which would be run are marked with an "
+            "asterix\n");
+    g_print("                symbol [*].  For files which would not be "
+            "run,\n");
+    g_print("                information is given for why they are "
+            "excluded\n");
+    g_print("  --help        Show this help and exit\n");
+    g_print("  --version     Show version and copyright information\n\n");
+    g_print("ENVIRONMENT specifies a list of environments for which to run "
+            "autostart\n");
+    g_print("applications.  If none are specified, only applications which "
+            "do not\n");
+    g_print("limit themselves to certain environments will be run.\n\n");
+    g_print("ENVIRONMENT can be one or more of:\n");
+    g_print("  OPENBOX       Openbox\n");
+    g_print("  GNOME         Gnome Desktop\n");
+    g_print("  KDE           KDE Desktop\n");
+    g_print("  LXDE          LXDE Desktop\n");
+    g_print("  ROX           ROX Desktop\n");
+    g_print("  XFCE          XFCE Desktop\n");
+    g_print("  Old           Legacy systems\n\n");
+}
+
+static void show_version(void)
+{
+    g_print("%s %s\n", ME, PACKAGE_VERSION);
+    g_print("Copyright (c) 2026        The Openbox developers\n");
+    g_print("Based on the Python version, "
+            "Copyright (c) 2008-2010   Dana Jansens\n\n");
+}
+
+/*! Returns the names of the .desktop files in a directory, sorted so that
+  they are always run in the same order */
+static GSList* read_names(const gchar *path)
+{
+    GDir *dir;
+    GSList *names;
+    const gchar *name;
+
+    if (!(dir = g_dir_open(path, 0, NULL))) return NULL;
+
+    names = NULL;
+    while ((name = g_dir_read_name(dir)))
+        if (g_str_has_suffix(name, ".desktop"))
+            names = g_slist_prepend(names, g_strdup(name));
+    g_dir_close(dir);
+
+    return g_slist_sort(names, (GCompareFunc)strcmp);
+}
+
+/*! Finds all the autostart files.  A file in a more important directory
+  replaces any file with the same name in the directories after it. */
+static GSList* find_files(ObtPaths *p)
+{
+    GHashTable *seen;
+    GSList *files, *it, *names, *n;
+
+    seen = g_hash_table_new(g_str_hash, g_str_equal);
+    files = NULL;
+    for (it = obt_paths_autostart_dirs(p); it; it = g_slist_next(it)) {
+        GSList one = { it->data, NULL };
+
+        names = read_names(it->data);
+        for (n = names; n; n = g_slist_next(n)) {
+            gchar *name = n->data;
+            AutostartFile *f;
+
+            if (g_hash_table_lookup(seen, name)) {
+                g_free(name);
+                continue;
+            }
+            /* the table owns the name now */
+            g_hash_table_insert(seen, name, name);
+
+            f = g_new(AutostartFile, 1);
+            f->path = g_build_filename(it->data, name, NULL);
+            if (!(f->link = obt_link_from_ddfile(name, &one, p))) {
+                g_print("Invalid .desktop file: %s\n", f->path);
+                g_free(f->path);
+                g_free(f);
+                continue;
+            }
+            files = g_slist_prepend(files, f);
+        }
+        g_slist_free(names);
+    }
+
+    g_hash_table_foreach(seen, (GHFunc)g_free, NULL);
+    g_hash_table_destroy(seen);
+    return g_slist_reverse(files);
+}
+
+static void alert(const gchar *s, gboolean info)
+{
+    g_print(info ? "\t  %s\n" : "\t* %s\n", s);
+}
+
+static gboolean should_run(AutostartFile *f, const gchar *envs,
+                           gboolean verbose)
+{
+    const gchar *tryexec;
+
+    if (obt_link_type(f->link) != OBT_LINK_TYPE_APPLICATION) {
+        if (verbose) alert("Excluded by: Missing Exec field", FALSE);
+        return FALSE;
+    }
+    if (obt_link_deleted(f->link)) {
+        if (verbose) alert("Excluded by: Hidden", FALSE);
+        return FALSE;
+    }
+    tryexec = obt_link_app_try_exec(f->link);
+    if (tryexec && !obt_link_app_runnable(f->link)) {
+        if (verbose) {
+            gchar *s = g_strdup_printf("Excluded by: TryExec (%s)", tryexec);
+            alert(s, FALSE);
+            g_free(s);
+        }
+        return FALSE;
+    }
+    if (!obt_link_show_in(f->link, envs)) {
+        if (verbose) alert("Excluded by: OnlyShowIn/NotShowIn", FALSE);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static void display(AutostartFile *f, const gchar *envs)
+{
+    gchar *s;
+
+    g_print("[%c] %s\n", should_run(f, envs, FALSE) ? '*' : ' ',
+            obt_link_name(f->link));
+    s = g_strdup_printf("File: %s", f->path);
+    alert(s, TRUE);
+    g_free(s);
+    if (obt_link_type(f->link) == OBT_LINK_TYPE_APPLICATION) {
+        s = g_strdup_printf("Executes: %s",
+                            obt_link_app_executable(f->link));
+        alert(s, TRUE);
+        g_free(s);
+    }
+    should_run(f, envs, TRUE);
+    g_print("\n");
+}
+
+/*! Removes the field codes (%f, %U, etc) from an Exec key, since there are
+  no files or urls to give to the application */
+static gchar* strip_field_codes(const gchar *exec)
+{
+    GString *s;
+    const gchar *c;
+
+    s = g_string_sized_new(strlen(exec));
+    for (c = exec; *c; ++c) {
+        if (*c != '%')
+            g_string_append_c(s, *c);
+        else if (*(c+1) == '%')
+            g_string_append_c(s, *++c);
+        else if (*(c+1))
+            ++c;
+    }
+    return g_string_free(s, FALSE);
+}
+
+/*! Starts the application without waiting for it, so that one slow
+  application doesn't hold up the others */
+static void run(AutostartFile *f, const gchar *envs)
+{
+    gchar *argv[4], *exec;
+    GError *e = NULL;
+
+    if (!should_run(f, envs, FALSE)) return;
+
+    exec = strip_field_codes(obt_link_app_executable(f->link));
+    argv[0] = "/bin/sh";
+    argv[1] = "-c";
+    argv[2] = g_strconcat("exec ", exec, NULL);
+    argv[3] = NULL;
+
+    if (!g_spawn_async(obt_link_app_path(f->link), argv, NULL, 0,
+                       NULL, NULL, NULL, &e))
+    {
+        g_printerr("%s: Failed to run %s: %s\n", ME, f->path, e->message);
+        g_error_free(e);
+    }
+
+    g_free(argv[2]);
+    g_free(exec);
+}
+
+gint main(gint argc, gchar **argv)
+{
+    ObtPaths *p;
+    GSList *files, *it;
+    GString *envs;
+    gboolean list = FALSE;
+    gint i;
+
+    envs = g_string_new("");
+    for (i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--help")) {
+            show_help();
+            return 0;
+        }
+        else if (!strcmp(argv[i], "--version")) {
+            show_version();
+            return 0;
+        }
+        else if (!strcmp(argv[i], "--list"))
+            list = TRUE;
+        else {
+            if (envs->len) g_string_append_c(envs, ';');
+            g_string_append(envs, argv[i]);
+        }
+    }
+
+    p = obt_paths_new();
+    files = find_files(p);
+
+    for (it = files; it; it = g_slist_next(it)) {
+        AutostartFile *f = it->data;
+
+        if (list) display(f, envs->str);
+        else run(f, envs->str);
+
+        obt_link_unref(f->link);
+        g_free(f->path);
+        g_free(f);
+    }
+
+    g_slist_free(files);
+    g_string_free(envs, TRUE);
+    obt_paths_unref(p);
+    return 0;
+}